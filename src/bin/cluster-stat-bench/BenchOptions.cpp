@@ -0,0 +1,89 @@
+// =============================================================================
+// cluster-stat-bench
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <BenchOptions.hpp>
+#include <stdio.h>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CStatBenchOptions::CStatBenchOptions(void)
+{
+    SetShowMiniUsage(true);
+}
+
+//------------------------------------------------------------------------------
+
+int CStatBenchOptions::CheckOptions(void)
+{
+    if( GetOptNodes() <= 0 ){
+        fprintf(stderr,"\n%s: number of nodes must be greater than zero\n",(const char*)GetProgramName());
+        return(SO_USER_ERROR);
+    }
+    if( GetOptInterval() < 0 ){
+        fprintf(stderr,"\n%s: interval must not be negative\n",(const char*)GetProgramName());
+        return(SO_USER_ERROR);
+    }
+    if( (GetOptChurn() < 0) || (GetOptChurn() > 100) ){
+        fprintf(stderr,"\n%s: churn must be in the range 0-100\n",(const char*)GetProgramName());
+        return(SO_USER_ERROR);
+    }
+    if( GetOptDuration() <= 0 ){
+        fprintf(stderr,"\n%s: duration must be greater than zero\n",(const char*)GetProgramName());
+        return(SO_USER_ERROR);
+    }
+    return(SO_CONTINUE);
+}
+
+//------------------------------------------------------------------------------
+
+int CStatBenchOptions::FinalizeOptions(void)
+{
+    bool ret_opt = false;
+
+    if( GetOptHelp() == true ) {
+        PrintUsage();
+        ret_opt = true;
+    }
+
+    if( GetOptVersion() == true ) {
+        PrintVersion();
+        ret_opt = true;
+    }
+
+    if( ret_opt == true ) {
+        printf("\n");
+        return(SO_EXIT);
+    }
+
+    return(SO_CONTINUE);
+}
+
+//------------------------------------------------------------------------------
+
+int CStatBenchOptions::CheckArguments(void)
+{
+    return(SO_CONTINUE);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,202 @@
+#ifndef ClusterStatBenchOptionsH
+#define ClusterStatBenchOptionsH
+// =============================================================================
+// cluster-stat-bench
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SimpleOptions.hpp>
+#include <StatMainHeader.hpp>
+
+//------------------------------------------------------------------------------
+
+class CStatBenchOptions : public CSimpleOptions {
+public:
+    // constructor - tune option setup
+    CStatBenchOptions(void);
+
+    // program name and description -----------------------------------------------
+    CSO_PROG_NAME_BEGIN
+    "cluster-stat-bench"
+    CSO_PROG_NAME_END
+
+    CSO_PROG_DESC_BEGIN
+    "The program replays synthetic node datagrams and drives concurrent FastCGI requests against cluster-stat-server."
+    CSO_PROG_DESC_END
+
+    CSO_PROG_VERS_BEGIN
+    StatBuildVersion
+    CSO_PROG_VERS_END
+
+    // list of all options and arguments ------------------------------------------
+    CSO_LIST_BEGIN
+    // arguments ------------------------------
+    CSO_ARG(CSmallString,ServerName)
+    // options ------------------------------
+    CSO_OPT(int,Port)
+    CSO_OPT(int,FCGIPort)
+    CSO_OPT(int,Nodes)
+    CSO_OPT(int,Interval)
+    CSO_OPT(int,Churn)
+    CSO_OPT(bool,Legacy)
+    CSO_OPT(int,Duration)
+    CSO_OPT(CSmallString,Clients)
+    CSO_OPT(CSmallString,Actions)
+    CSO_OPT(CSmallString,User)
+    CSO_OPT(bool,Help)
+    CSO_OPT(bool,Version)
+    CSO_OPT(bool,Verbose)
+    CSO_LIST_END
+
+    CSO_MAP_BEGIN
+    // description of arguments ---------------------------------------------------
+    CSO_MAP_ARG(CSmallString,                   /* argument type */
+                ServerName,                          /* argument name */
+                NULL,                           /* default value */
+                true,                           /* is argument mandatory */
+                "servername",                        /* parametr name */
+                "IP address or name of tested server\n")   /* argument description */
+    // description of options -----------------------------------------------------
+    CSO_MAP_OPT(int,                            /* option type */
+                Port,                           /* option name */
+                32598,                          /* default value */
+                false,                          /* is option mandatory */
+                'p',                           /* short option name */
+                "port",                      /* long option name */
+                "PORT",                           /* parametr name */
+                "port for stat datagrams (statport)")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                            /* option type */
+                FCGIPort,                           /* option name */
+                32597,                          /* default value */
+                false,                          /* is option mandatory */
+                'f',                           /* short option name */
+                "fcgiport",                      /* long option name */
+                "PORT",                           /* parametr name */
+                "port of FastCGI server (fcgiport), it is also used to read server metrics")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                            /* option type */
+                Nodes,                           /* option name */
+                100,                          /* default value */
+                false,                          /* is option mandatory */
+                'n',                           /* short option name */
+                "nodes",                      /* long option name */
+                "NUMBER",                           /* parametr name */
+                "number of virtual nodes (the server accepts at most maxnodes)")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                            /* option type */
+                Interval,                           /* option name */
+                15,                          /* default value */
+                false,                          /* is option mandatory */
+                'i',                           /* short option name */
+                "interval",                      /* long option name */
+                "TIME",                           /* parametr name */
+                "delay (in seconds) between updates of one node (zero value means as fast as possible)")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                            /* option type */
+                Churn,                           /* option name */
+                10,                          /* default value */
+                false,                          /* is option mandatory */
+                'c',                           /* short option name */
+                "churn",                      /* long option name */
+                "PERCENT",                           /* parametr name */
+                "probability that sessions of a node change between updates, unchanged nodes send heartbeats")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Legacy,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                'L',                           /* short option name */
+                "legacy",                      /* long option name */
+                NULL,                           /* parametr name */
+                "send version 3 datagrams (full update every time) to benchmark old servers")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                            /* option type */
+                Duration,                           /* option name */
+                30,                          /* default value */
+                false,                          /* is option mandatory */
+                'd',                           /* short option name */
+                "duration",                      /* long option name */
+                "TIME",                           /* parametr name */
+                "duration (in seconds) of each measurement phase")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(CSmallString,                   /* option type */
+                Clients,                           /* option name */
+                "1,8,32",                          /* default value */
+                false,                          /* is option mandatory */
+                'l',                           /* short option name */
+                "clients",                      /* long option name */
+                "LIST",                           /* parametr name */
+                "comma separated numbers of concurrent FastCGI clients, one phase is run for each number (zero value means datagram replay only)")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(CSmallString,                   /* option type */
+                Actions,                           /* option name */
+                "loggedusers,allseats,metrics",                          /* default value */
+                false,                          /* is option mandatory */
+                'a',                           /* short option name */
+                "actions",                      /* long option name */
+                "LIST",                           /* parametr name */
+                "comma separated list of requested actions")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(CSmallString,                   /* option type */
+                User,                           /* option name */
+                NULL,                          /* default value */
+                false,                          /* is option mandatory */
+                'u',                           /* short option name */
+                "user",                      /* long option name */
+                "NAME",                           /* parametr name */
+                "REMOTE_USER passed to the server (required by the remote action)")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Verbose,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                'v',                           /* short option name */
+                "verbose",                      /* long option name */
+                NULL,                           /* parametr name */
+                "increase output verbosity")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Version,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                '\0',                           /* short option name */
+                "version",                      /* long option name */
+                NULL,                           /* parametr name */
+                "output version information and exit")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Help,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                'h',                           /* short option name */
+                "help",                      /* long option name */
+                NULL,                           /* parametr name */
+                "display this help and exit")   /* option description */
+    CSO_MAP_END
+
+    // final operation with options ------------------------------------------------
+private:
+    virtual int CheckOptions(void);
+    virtual int FinalizeOptions(void);
+    virtual int CheckArguments(void);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,267 @@
+// =============================================================================
+// cluster-stat-bench
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <DatagramReplay.hpp>
+#include <StatPacket.hpp>
+#include <ErrorSystem.hpp>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <stdio.h>
+#include <list>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CDatagramReplay::CDatagramReplay(void)
+{
+    Socket      = -1;
+    Interval    = 15;
+    Churn       = 10;
+    Legacy      = false;
+    Seed        = getpid();
+    LastBuild   = 0;
+}
+
+//------------------------------------------------------------------------------
+
+CDatagramReplay::~CDatagramReplay(void)
+{
+    if( Socket >= 0 ) close(Socket);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CDatagramReplay::Init(const CSmallString& server,int port,int nodes,int interval,int churn,bool legacy)
+{
+    Interval    = interval;
+    Churn       = churn;
+    Legacy      = legacy;
+
+    // virtual nodes
+    NodeNames.resize(nodes);
+    NodeVariants.assign(nodes,-1);
+    for(int i=0; i < nodes; i++){
+        char name[NAME_SIZE];
+        snprintf(name,NAME_SIZE,"bench%05d",i+1);
+        NodeNames[i] = name;
+    }
+
+    // open socket
+    addrinfo    hints;
+    addrinfo*   p_addrinfo;
+    memset(&hints,0,sizeof(hints));
+    hints.ai_family     = AF_INET;
+    hints.ai_socktype   = SOCK_DGRAM;
+
+    CSmallString sport;
+    sport << port;
+
+    int nerr;
+    if( (nerr = getaddrinfo(server,sport,&hints,&p_addrinfo)) != 0 ) {
+        CSmallString error;
+        error << "unable to decode server name '" << server
+              << "' (" <<  gai_strerror(nerr) << ")";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    Socket = socket(p_addrinfo->ai_family,p_addrinfo->ai_socktype,p_addrinfo->ai_protocol);
+    if( Socket == -1 ) {
+        CSmallString error;
+        error << "unable to create socket (" << strerror(errno) << ")";
+        ES_ERROR(error);
+        freeaddrinfo(p_addrinfo);
+        return(false);
+    }
+
+    if( connect(Socket,p_addrinfo->ai_addr,p_addrinfo->ai_addrlen) == -1 ) {
+        CSmallString error;
+        error << "unable to connect to server " << server << " (" << strerror(errno) << ")";
+        ES_ERROR(error);
+        freeaddrinfo(p_addrinfo);
+        return(false);
+    }
+
+    freeaddrinfo(p_addrinfo);
+
+    BuildVariants();
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CDatagramReplay::ExecuteThread(void)
+{
+    int num_of_nodes = NodeNames.size();
+
+    while( ThreadTerminated == false ){
+        double round_start = CMetrics::GetTime();
+        if( round_start - LastBuild > REPLAY_REFRESH_TIME ) BuildVariants();
+
+        for(int i=0; (i < num_of_nodes) && (ThreadTerminated == false); i++){
+            SendNode(i);
+
+            // spread updates over the interval
+            if( Interval > 0 ){
+                double target = round_start + (double)Interval*(i+1)/num_of_nodes;
+                double now = CMetrics::GetTime();
+                if( target > now ) usleep((target - now)*1.0e6);
+            }
+        }
+
+        Rounds.Inc();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CDatagramReplay::BuildVariants(void)
+{
+    for(int k=0; k < REPLAY_NUM_OF_VARIANTS; k++){
+        std::list<CUserSession> sessions;
+
+        CUserSession local;
+        snprintf(local.UserName,NAME_SIZE,"benchuser%d",k);
+        snprintf(local.LoginName,NAME_SIZE,"benchuser%d",k);
+        local.ActiveTTY = true;
+
+        CUserSession remote;
+        snprintf(remote.UserName,NAME_SIZE,"remoteuser%d",k);
+        snprintf(remote.LoginName,NAME_SIZE,"remoteuser%d",k);
+        remote.Remote = true;
+
+        switch(k){
+            case 0:     // empty node
+                break;
+            case 1:     // local X11 session
+                local.X11 = true;
+                sessions.push_back(local);
+                break;
+            case 2:     // local Wayland session
+                local.Wayland = true;
+                sessions.push_back(local);
+                break;
+            case 3:     // ssh session
+                sessions.push_back(remote);
+                break;
+            case 4:     // VNC session
+                remote.VNC = true;
+                remote.DisplayID = ":1";
+                sessions.push_back(remote);
+                break;
+            case 5:     // RDSK session
+                remote.RDSK = true;
+                remote.DisplayID = ":2";
+                sessions.push_back(remote);
+                break;
+            case 6:     // local and ssh sessions
+                local.X11 = true;
+                sessions.push_back(local);
+                sessions.push_back(remote);
+                break;
+            default:    // busy node
+                local.X11 = true;
+                sessions.push_back(local);
+                for(int i=0; i < 3; i++){
+                    CUserSession ses = remote;
+                    snprintf(ses.LoginName,NAME_SIZE,"remoteuser%d",i);
+                    ses.VNC  = (i == 1);
+                    ses.RDSK = (i == 2);
+                    if( i > 0 ) ses.DisplayID = (i == 1) ? ":1" : ":2";
+                    sessions.push_back(ses);
+                }
+                break;
+        }
+
+        Variants[k].SetDatagram(sessions,false);
+    }
+
+    LastBuild = CMetrics::GetTime();
+}
+
+//------------------------------------------------------------------------------
+
+void CDatagramReplay::SendNode(int id)
+{
+    int     variant = NodeVariants[id];
+    bool    full = false;
+
+    if( variant < 0 ){
+        // the server does not know the node yet
+        variant = rand_r(&Seed) % REPLAY_NUM_OF_VARIANTS;
+        full = true;
+    } else if( (int)(rand_r(&Seed) % 100) < Churn ){
+        // change to a different layout
+        variant = (variant + 1 + rand_r(&Seed) % (REPLAY_NUM_OF_VARIANTS - 1)) % REPLAY_NUM_OF_VARIANTS;
+        full = true;
+    }
+    NodeVariants[id] = variant;
+
+    CStatDatagram& dtg = Variants[variant];
+    dtg.SetNodeName(NodeNames[id].c_str());
+
+    char    buffer[STAT_PACKET_MAX_SIZE];
+    size_t  size;
+
+    if( Legacy ){
+        // version 3 protocol does not have heartbeats
+        size = dtg.SerializeV3(buffer,sizeof(buffer));
+        full = true;
+    } else if( full ){
+        size = dtg.Serialize(buffer,sizeof(buffer));
+    } else {
+        CStatHeartbeat heartbeat;
+        heartbeat.SetHeartbeat(dtg);
+        size = heartbeat.Serialize(buffer,sizeof(buffer));
+    }
+
+    if( (size == 0) || (send(Socket,buffer,size,MSG_NOSIGNAL) != (ssize_t)size) ){
+        SendErrors.Inc();
+        // the next update must be full
+        NodeVariants[id] = -1;
+        return;
+    }
+
+    if( full ){
+        Datagrams.Inc();
+    } else {
+        Heartbeats.Inc();
+    }
+    Bytes.Inc(size);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,87 @@
+#ifndef DatagramReplayH
+#define DatagramReplayH
+// =============================================================================
+// cluster-stat-bench
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SmartThread.hpp>
+#include <SmallString.hpp>
+#include <StatDatagram.hpp>
+#include <Metrics.hpp>
+#include <vector>
+#include <string>
+
+// -----------------------------------------------------------------------------
+
+#define REPLAY_NUM_OF_VARIANTS  8       // distinct session layouts
+#define REPLAY_REFRESH_TIME     60      // rebuild layouts to keep time stamps fresh
+
+// -----------------------------------------------------------------------------
+
+//! send datagrams of virtual nodes to the stat port
+/*!
+  each node is updated once per interval, the updates are spread evenly over
+  the interval; a node changes its sessions with the given probability (churn)
+  and sends a full datagram, otherwise it sends a heartbeat like the client
+
+  in the legacy mode, each update is a version 3 memory image like
+  the clients before version 4, thus also old servers can be measured
+*/
+
+class CDatagramReplay : public CSmartThread {
+public:
+// constructor and destructors -------------------------------------------------
+    CDatagramReplay(void);
+    ~CDatagramReplay(void);
+
+// setup methods ---------------------------------------------------------------
+    /// open socket and prepare virtual nodes
+    bool Init(const CSmallString& server,int port,int nodes,int interval,int churn,bool legacy);
+
+// statistics ------------------------------------------------------------------
+    CMetricCounter  Datagrams;      // full datagrams
+    CMetricCounter  Heartbeats;
+    CMetricCounter  Bytes;
+    CMetricCounter  SendErrors;
+    CMetricCounter  Rounds;         // all nodes were updated
+
+// section of private data -----------------------------------------------------
+private:
+    int                         Socket;
+    int                         Interval;
+    int                         Churn;
+    bool                        Legacy;
+    unsigned int                Seed;
+    std::vector<std::string>    NodeNames;
+    std::vector<int>            NodeVariants;   // -1 - not registered yet
+    CStatDatagram               Variants[REPLAY_NUM_OF_VARIANTS];
+    double                      LastBuild;
+
+    virtual void ExecuteThread(void);
+
+    // prepare session layouts
+    void BuildVariants(void);
+
+    // send update of one node
+    void SendNode(int id);
+};
+
+// -----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,232 @@
+// =============================================================================
+// cluster-stat-bench
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <FCGIClient.hpp>
+#include <ErrorSystem.hpp>
+#include <sys/types.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+// FastCGI protocol, version 1
+#define FCGI_VERSION_1          1
+#define FCGI_HEADER_LEN         8
+#define FCGI_BEGIN_REQUEST      1
+#define FCGI_END_REQUEST        3
+#define FCGI_PARAMS             4
+#define FCGI_STDIN              5
+#define FCGI_STDOUT             6
+#define FCGI_RESPONDER          1
+#define FCGI_REQUEST_ID         1
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CFCGIClient::CFCGIClient(void)
+{
+    memset(&Address,0,sizeof(Address));
+    AddressLen = 0;
+}
+
+//------------------------------------------------------------------------------
+
+bool CFCGIClient::SetServer(const CSmallString& server,int port)
+{
+    addrinfo    hints;
+    addrinfo*   p_addrinfo;
+    memset(&hints,0,sizeof(hints));
+    hints.ai_family     = AF_INET;
+    hints.ai_socktype   = SOCK_STREAM;
+
+    CSmallString sport;
+    sport << port;
+
+    int nerr;
+    if( (nerr = getaddrinfo(server,sport,&hints,&p_addrinfo)) != 0 ) {
+        CSmallString error;
+        error << "unable to decode server name '" << server
+              << "' (" <<  gai_strerror(nerr) << ")";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    memcpy(&Address,p_addrinfo->ai_addr,p_addrinfo->ai_addrlen);
+    AddressLen = p_addrinfo->ai_addrlen;
+    freeaddrinfo(p_addrinfo);
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CFCGIClient::Request(const CFCGIParams& params,int& status,std::string& body)
+{
+    status = 0;
+    body.clear();
+
+    // encode request ---------------------------
+    string out;
+
+    string begin(8,'\0');
+    begin[1] = FCGI_RESPONDER;     // role, flags = 0 - do not keep connection
+    PutRecord(out,FCGI_BEGIN_REQUEST,begin);
+
+    string pairs;
+    CFCGIParams::const_iterator it = params.begin();
+    CFCGIParams::const_iterator ie = params.end();
+    while( it != ie ){
+        PutLength(pairs,it->first.size());
+        PutLength(pairs,it->second.size());
+        pairs += it->first;
+        pairs += it->second;
+        it++;
+    }
+    PutRecord(out,FCGI_PARAMS,pairs);
+    PutRecord(out,FCGI_PARAMS,"");      // end of params
+    PutRecord(out,FCGI_STDIN,"");       // empty body
+
+    // send request -----------------------------
+    int fd = socket(Address.ss_family,SOCK_STREAM,0);
+    if( fd == -1 ){
+        ES_ERROR("unable to create socket");
+        return(false);
+    }
+
+    if( connect(fd,(sockaddr*)&Address,AddressLen) == -1 ){
+        close(fd);
+        return(false);
+    }
+
+    if( send(fd,out.data(),out.size(),MSG_NOSIGNAL) != (ssize_t)out.size() ){
+        close(fd);
+        return(false);
+    }
+
+    // read response ----------------------------
+    string          stdout_data;
+    bool            finished = false;
+    unsigned char   header[FCGI_HEADER_LEN];
+    unsigned char   content[65535+255];
+
+    while( finished == false ){
+        if( ReadAll(fd,header,FCGI_HEADER_LEN) == false ) break;
+        size_t clen = (header[4] << 8) | header[5];
+        size_t plen = header[6];
+        if( ReadAll(fd,content,clen+plen) == false ) break;
+
+        switch(header[1]){
+            case FCGI_STDOUT:
+                stdout_data.append((const char*)content,clen);
+                break;
+            case FCGI_END_REQUEST:
+                finished = true;
+                break;
+            default:
+                // stderr and management records are ignored
+                break;
+        }
+    }
+
+    close(fd);
+
+    if( finished == false ) return(false);
+
+    // split headers and body -------------------
+    size_t pos = stdout_data.find("\r\n\r\n");
+    if( pos == string::npos ) return(false);
+
+    string headers = stdout_data.substr(0,pos);
+    body = stdout_data.substr(pos+4);
+
+    status = 200;
+    if( headers.compare(0,8,"Status: ") == 0 ){
+        status = atoi(headers.c_str()+8);
+    } else {
+        size_t spos = headers.find("\r\nStatus: ");
+        if( spos != string::npos ) status = atoi(headers.c_str()+spos+10);
+    }
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CFCGIClient::PutRecord(std::string& out,int type,const std::string& content)
+{
+    size_t len = content.size();
+
+    out += (char)FCGI_VERSION_1;
+    out += (char)type;
+    out += (char)((FCGI_REQUEST_ID >> 8) & 0xFF);
+    out += (char)(FCGI_REQUEST_ID & 0xFF);
+    out += (char)((len >> 8) & 0xFF);
+    out += (char)(len & 0xFF);
+    out += (char)0;     // padding
+    out += (char)0;     // reserved
+    out += content;
+}
+
+//------------------------------------------------------------------------------
+
+void CFCGIClient::PutLength(std::string& out,size_t len)
+{
+    if( len < 128 ){
+        out += (char)len;
+        return;
+    }
+    out += (char)(((len >> 24) & 0x7F) | 0x80);
+    out += (char)((len >> 16) & 0xFF);
+    out += (char)((len >> 8) & 0xFF);
+    out += (char)(len & 0xFF);
+}
+
+//------------------------------------------------------------------------------
+
+bool CFCGIClient::ReadAll(int fd,unsigned char* p_buffer,size_t len)
+{
+    size_t pos = 0;
+    while( pos < len ){
+        ssize_t n = recv(fd,p_buffer+pos,len-pos,0);
+        if( n < 0 ){
+            if( errno == EINTR ) continue;
+            return(false);
+        }
+        if( n == 0 ) return(false);
+        pos += n;
+    }
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
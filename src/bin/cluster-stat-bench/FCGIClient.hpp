@@ -0,0 +1,65 @@
+#ifndef FCGIClientH
+#define FCGIClientH
+// =============================================================================
+// cluster-stat-bench
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SmallString.hpp>
+#include <sys/socket.h>
+#include <map>
+#include <string>
+
+// -----------------------------------------------------------------------------
+
+typedef std::map<std::string,std::string>  CFCGIParams;
+
+// -----------------------------------------------------------------------------
+
+//! minimal FastCGI client, it plays the role of the web server
+/*!
+  one responder request is sent per connection, the connection is closed
+  by the application after the request is finished
+*/
+
+class CFCGIClient {
+public:
+// constructor and destructors -------------------------------------------------
+    CFCGIClient(void);
+
+// setup methods ---------------------------------------------------------------
+    /// resolve server address
+    bool SetServer(const CSmallString& server,int port);
+
+// executive methods -----------------------------------------------------------
+    /// send request and read response, status is the HTTP status code
+    bool Request(const CFCGIParams& params,int& status,std::string& body);
+
+// section of private data -----------------------------------------------------
+private:
+    sockaddr_storage    Address;
+    socklen_t           AddressLen;
+
+    static void PutRecord(std::string& out,int type,const std::string& content);
+    static void PutLength(std::string& out,size_t len);
+    static bool ReadAll(int fd,unsigned char* p_buffer,size_t len);
+};
+
+// -----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,123 @@
+// =============================================================================
+// cluster-stat-bench
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <FCGILoad.hpp>
+#include <Metrics.hpp>
+#include <math.h>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CFCGIActionStat::CFCGIActionStat(void)
+{
+    Errors = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void CFCGIActionStat::Merge(const CFCGIActionStat& other)
+{
+    Latencies.insert(Latencies.end(),other.Latencies.begin(),other.Latencies.end());
+    Errors += other.Errors;
+}
+
+//------------------------------------------------------------------------------
+
+double CFCGIActionStat::GetPercentile(double percent) const
+{
+    if( Latencies.empty() ) return(0.0);
+    // nearest rank
+    size_t rank = (size_t)ceil(percent/100.0*Latencies.size());
+    if( rank < 1 ) rank = 1;
+    if( rank > Latencies.size() ) rank = Latencies.size();
+    return(Latencies[rank-1]);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CFCGILoad::CFCGILoad(void)
+{
+    First = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void CFCGILoad::Init(const CFCGIClient& client,const std::vector<std::string>& actions,
+                     const CSmallString& user,int first)
+{
+    Client  = client;
+    Actions = actions;
+    User    = user;
+    First   = first;
+    Results.assign(Actions.size(),CFCGIActionStat());
+}
+
+//------------------------------------------------------------------------------
+
+const std::vector<CFCGIActionStat>& CFCGILoad::GetResults(void) const
+{
+    return(Results);
+}
+
+//------------------------------------------------------------------------------
+
+void CFCGILoad::ExecuteThread(void)
+{
+    if( Actions.empty() ) return;
+
+    // the same parameters as passed by the web server
+    CFCGIParams params;
+    params["REQUEST_METHOD"]    = "GET";
+    params["SCRIPT_NAME"]       = "/cluster-stat";
+    params["SERVER_NAME"]       = "localhost";
+    params["SERVER_PORT"]       = "80";
+    if( User != NULL ) params["REMOTE_USER"] = (const char*)User;
+
+    size_t id = First % Actions.size();
+    string body;
+
+    while( ThreadTerminated == false ){
+        params["QUERY_STRING"] = "action=" + Actions[id];
+
+        int     status;
+        double  start = CMetrics::GetTime();
+        bool    result = Client.Request(params,status,body);
+        double  duration = CMetrics::GetTime() - start;
+
+        if( (result == false) || (status >= 400) ){
+            Results[id].Errors++;
+        } else {
+            Results[id].Latencies.push_back(duration);
+        }
+
+        id = (id + 1) % Actions.size();
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,81 @@
+#ifndef FCGILoadH
+#define FCGILoadH
+// =============================================================================
+// cluster-stat-bench
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SmartThread.hpp>
+#include <FCGIClient.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+#include <string>
+
+// -----------------------------------------------------------------------------
+
+//! results for one action
+class CFCGIActionStat {
+public:
+    CFCGIActionStat(void);
+
+public:
+    std::vector<double> Latencies;  // successful requests, in seconds
+    unsigned long       Errors;     // failed requests and 4xx/5xx responses
+
+    //! add results of another client
+    void Merge(const CFCGIActionStat& other);
+
+    //! get latency percentile (0-100) in seconds, latencies must be sorted
+    double GetPercentile(double percent) const;
+};
+
+// -----------------------------------------------------------------------------
+
+//! one concurrent FastCGI client, actions are requested round-robin
+
+class CFCGILoad : public CSmartThread {
+public:
+// constructor and destructors -------------------------------------------------
+    CFCGILoad(void);
+
+// setup methods ---------------------------------------------------------------
+    void Init(const CFCGIClient& client,const std::vector<std::string>& actions,
+              const CSmallString& user,int first);
+
+// results ---------------------------------------------------------------------
+    //! per action results, valid after the thread is finished
+    const std::vector<CFCGIActionStat>& GetResults(void) const;
+
+// section of private data -----------------------------------------------------
+private:
+    CFCGIClient                     Client;
+    std::vector<std::string>        Actions;
+    CSmallString                    User;
+    int                             First;
+    std::vector<CFCGIActionStat>    Results;
+
+    virtual void ExecuteThread(void);
+};
+
+// -----------------------------------------------------------------------------
+
+typedef boost::shared_ptr<CFCGILoad>    CFCGILoadPtr;
+
+// -----------------------------------------------------------------------------
+
+#endif
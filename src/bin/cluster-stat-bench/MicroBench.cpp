@@ -0,0 +1,361 @@
+// =============================================================================
+// cluster-stat-bench
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <MicroBench.hpp>
+#include <StatDatagram.hpp>
+#include <StatPacket.hpp>
+#include <StatChecksum.hpp>
+#include <ErrorSystem.hpp>
+#include <Metrics.hpp>
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+CMicroBench MicroBench;
+
+MAIN_ENTRY_OBJECT(MicroBench)
+
+using namespace std;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+// test data - typical node with an active local session and several remote sessions
+static CStatDatagram    Datagram;
+static CStatDatagram    Target;
+static CStatDatagramV3  LegacyDatagram;
+static char             DatagramPacket[STAT_PACKET_MAX_SIZE];
+static size_t           DatagramPacketLen = 0;
+static char             HeartbeatPacket[STAT_PACKET_MAX_SIZE];
+static size_t           HeartbeatPacketLen = 0;
+static char             Buffer[STAT_PACKET_MAX_SIZE];
+
+//------------------------------------------------------------------------------
+
+// do not let the compiler remove the measured operation
+static void Escape(const void* p_data)
+{
+    __asm__ __volatile__("" : : "g"(p_data) : "memory");
+}
+
+//------------------------------------------------------------------------------
+
+static void BenchConstruct(long n)
+{
+    for(long i=0; i < n; i++){
+        CStatDatagram dtg;
+        Escape(&dtg);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static void BenchClear(long n)
+{
+    for(long i=0; i < n; i++){
+        Target.Clear();
+        Escape(&Target);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static void BenchCopy(long n)
+{
+    for(long i=0; i < n; i++){
+        Target = Datagram;
+        Escape(&Target);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static void BenchGetRemoteLoginName(long n)
+{
+    for(long i=0; i < n; i++){
+        CSmallString name = Datagram.GetRemoteLoginName(i & 3);
+        Escape(&name);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static void BenchStateHash(long n)
+{
+    for(long i=0; i < n; i++){
+        unsigned int hash = Datagram.GetStateHash();
+        Escape(&hash);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static void BenchSerialize(long n)
+{
+    for(long i=0; i < n; i++){
+        size_t len = Datagram.Serialize(Buffer,sizeof(Buffer));
+        Escape(&len);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static void BenchDeserialize(long n)
+{
+    for(long i=0; i < n; i++){
+        bool result = Target.Deserialize(DatagramPacket,DatagramPacketLen);
+        Escape(&result);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static void BenchHeartbeatDeserialize(long n)
+{
+    for(long i=0; i < n; i++){
+        CStatHeartbeat heartbeat;
+        bool result = heartbeat.Deserialize(HeartbeatPacket,HeartbeatPacketLen);
+        Escape(&result);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static void BenchLegacyIsValid(long n)
+{
+    for(long i=0; i < n; i++){
+        bool result = LegacyDatagram.IsValid();
+        Escape(&result);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static void BenchCRC32C(long n)
+{
+    for(long i=0; i < n; i++){
+        unsigned int crc = StatCRC32C(0,&LegacyDatagram,sizeof(LegacyDatagram));
+        Escape(&crc);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static void BenchCRC32CSoft(long n)
+{
+    for(long i=0; i < n; i++){
+        unsigned int crc = StatCRC32CSoft(0,&LegacyDatagram,sizeof(LegacyDatagram));
+        Escape(&crc);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static void BenchByteSum(long n)
+{
+    const unsigned char* p_data = reinterpret_cast<const unsigned char*>(&LegacyDatagram);
+    for(long i=0; i < n; i++){
+        int sum = 0;
+        for(size_t k=0; k < sizeof(LegacyDatagram); k++){
+            sum += p_data[k];
+        }
+        Escape(&sum);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static const CMicroBenchCase Cases[] = {
+    { "datagram/construct",             BenchConstruct },
+    { "datagram/clear",                 BenchClear },
+    { "datagram/copy",                  BenchCopy },
+    { "datagram/get-remote-login-name", BenchGetRemoteLoginName },
+    { "datagram/state-hash",            BenchStateHash },
+    { "datagram/serialize",             BenchSerialize },
+    { "datagram/deserialize",           BenchDeserialize },
+    { "heartbeat/deserialize",          BenchHeartbeatDeserialize },
+    { "legacy-v3/is-valid",             BenchLegacyIsValid },
+    { "checksum/crc32c",                BenchCRC32C },
+    { "checksum/crc32c-soft",           BenchCRC32CSoft },
+    { "checksum/byte-sum",              BenchByteSum },
+    { NULL,                             NULL }
+};
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CMicroBench::CMicroBench(void)
+{
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+int CMicroBench::Init(int argc, char* argv[])
+{
+    // encode program options, all check procedures are done inside of CABFIntOpts
+    int result = Options.ParseCmdLine(argc,argv);
+
+    // should we exit or was it error?
+    if( result != SO_CONTINUE ) return(result);
+
+    // attach verbose stream to terminal stream and set desired verbosity level
+    vout.Attach(Console);
+    if( Options.GetOptVerbose() ) {
+        vout.Verbosity(CVerboseStr::high);
+    } else {
+        vout.Verbosity(CVerboseStr::low);
+    }
+
+    return(SO_CONTINUE);
+}
+
+//------------------------------------------------------------------------------
+
+bool CMicroBench::Run(void)
+{
+    Prepare();
+
+    vout << low;
+    vout << "# ==============================================================================" << endl;
+    vout << "# cluster-stat-microbench" << endl;
+    vout << "# ==============================================================================" << endl;
+    vout << "# sizeof(CStatDatagram)    = " << sizeof(CStatDatagram) << endl;
+    vout << "# sizeof(CStatDatagramV3)  = " << sizeof(CStatDatagramV3) << endl;
+    vout << "# Datagram packet [bytes]  = " << DatagramPacketLen << endl;
+    vout << "# Heartbeat packet [bytes] = " << HeartbeatPacketLen << endl;
+    vout << "# Hardware CRC32C          = " << (StatCRC32CIsHW() ? "yes" : "no") << endl;
+    vout << "# Time per measurement     = " << Options.GetOptTime() << " ms" << endl;
+    vout << "# Number of measurements   = " << Options.GetOptRepeats() << endl;
+    vout << endl;
+    vout << "# case                           median[ns/op]    min[ns/op]      ops/s" << endl;
+    vout << "# ------------------------------ ------------- ------------- ----------" << endl;
+
+    for(int i=0; Cases[i].Name != NULL; i++){
+        if( (Options.GetOptFilter() != NULL) && (strstr(Cases[i].Name,Options.GetOptFilter()) == NULL) ) continue;
+        Measure(Cases[i]);
+    }
+    vout << endl;
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void CMicroBench::Finalize(void)
+{
+    if( Options.GetOptVerbose() || ErrorSystem.IsError() ) {
+        ErrorSystem.PrintErrors(stderr);
+        fprintf(stderr,"\n");
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CMicroBench::Prepare(void)
+{
+    // v4 datagram - it is decoded to get the same state as on the server
+    CStatPacketWriter dpacket(DatagramPacket,sizeof(DatagramPacket),ESPT_DATAGRAM);
+    dpacket.PutString(ESPG_NODE_NAME,"wolf01");
+    dpacket.PutString(ESPG_FULL_NODE_NAME,"wolf01.cluster.example.org");
+    dpacket.PutInt(ESPG_TIME_STAMP,1600000000);
+    dpacket.PutInt(ESPG_POWER_DOWN,0);
+    dpacket.PutInt(ESPG_REMOTE_COUNTS,2,2);
+    dpacket.PutSession(ESPG_ACTIVE_SESSION,'X',"student01","student01","");
+    dpacket.PutSession(ESPG_LOCAL_SESSION,'X',"student01","student01","");
+    dpacket.PutSession(ESPG_LOCAL_SESSION,'W',"student02","student02","");
+    const char types[] = "SSVVRR";
+    for(int i=0; i < 6; i++){
+        char user[NAME_SIZE];
+        char display[NAME_SIZE];
+        snprintf(user,NAME_SIZE,"remoteuser%02d",i+1);
+        snprintf(display,NAME_SIZE,":%d",i+1);
+        dpacket.PutSession(ESPG_REMOTE_SESSION,types[i],user,user,display);
+    }
+    DatagramPacketLen = dpacket.Finish();
+    if( Datagram.Deserialize(DatagramPacket,DatagramPacketLen) == false ){
+        ES_ERROR("unable to decode test datagram");
+    }
+
+    // heartbeat
+    CStatPacketWriter hpacket(HeartbeatPacket,sizeof(HeartbeatPacket),ESPT_HEARTBEAT);
+    hpacket.PutString(ESPG_NODE_NAME,"wolf01");
+    hpacket.PutInt(ESPG_STATE_HASH,Datagram.GetStateHash());
+    hpacket.PutInt(ESPG_TIME_STAMP,1600000000);
+    HeartbeatPacketLen = hpacket.Finish();
+
+    // legacy image, only the validation cost is measured
+    memset(&LegacyDatagram,0,sizeof(LegacyDatagram));
+    memcpy(LegacyDatagram.Header,STAT_PACKET_MAGIC,V3_HEADER_SIZE);
+    strncpy(LegacyDatagram.NodeName,"wolf01",V3_NAME_SIZE-1);
+    strncpy(LegacyDatagram.FullNodeName,"wolf01.cluster.example.org",V3_NAME_SIZE-1);
+}
+
+//------------------------------------------------------------------------------
+
+void CMicroBench::Measure(const CMicroBenchCase& bcase)
+{
+    double min_time = Options.GetOptTime() * 1.0e-3;
+
+    // calibrate number of iterations
+    long    n = 1;
+    double  time = Execute(bcase.Function,n);
+    while( time < min_time * 0.1 ){
+        n *= 10;
+        time = Execute(bcase.Function,n);
+    }
+    if( time < min_time ) n = (long)(n * min_time / time) + 1;
+
+    // measure
+    vector<double> results;
+    for(int i=0; i < Options.GetOptRepeats(); i++){
+        results.push_back(Execute(bcase.Function,n) / n * 1.0e9);
+    }
+    sort(results.begin(),results.end());
+
+    double median = results[results.size()/2];
+    vout << "  " << left << setw(30) << bcase.Name << right;
+    vout << " " << setw(13) << fixed << setprecision(1) << median;
+    vout << " " << setw(13) << results[0];
+    vout << " " << setw(10) << scientific << setprecision(3) << 1.0e9 / median;
+    vout << endl;
+}
+
+//------------------------------------------------------------------------------
+
+double CMicroBench::Execute(MICRO_BENCH_FCE fce,long n)
+{
+    double start = CMetrics::GetTime();
+    fce(n);
+    return(CMetrics::GetTime() - start);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
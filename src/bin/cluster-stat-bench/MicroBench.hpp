@@ -0,0 +1,81 @@
+#ifndef ClusterStatMicroBenchH
+#define ClusterStatMicroBenchH
+// =============================================================================
+// cluster-stat-bench
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <VerboseStr.hpp>
+#include <TerminalStr.hpp>
+#include <MicroBenchOptions.hpp>
+
+// -----------------------------------------------------------------------------
+
+//! benchmark function, it must execute the measured operation n times
+typedef void (*MICRO_BENCH_FCE)(long n);
+
+//! one measured operation
+class CMicroBenchCase {
+public:
+    const char*     Name;
+    MICRO_BENCH_FCE Function;
+};
+
+// -----------------------------------------------------------------------------
+
+//! micro-benchmarks of datagram handling
+/*!
+  each case is calibrated to run at least the given time, then it is measured
+  repeatedly and the median and minimum times per operation are reported;
+  the numbers are meaningful only for release builds
+*/
+
+class CMicroBench {
+public:
+// constructor and destructors -------------------------------------------------
+    CMicroBench(void);
+
+// main methods ----------------------------------------------------------------
+    /// init options
+    int Init(int argc,char* argv[]);
+
+    /// main part of program
+    bool Run(void);
+
+    /// finalize
+    void Finalize(void);
+
+// section of private data -----------------------------------------------------
+private:
+    CMicroBenchOptions  Options;
+    CTerminalStr        Console;
+    CVerboseStr         vout;
+
+    /// prepare test data
+    void Prepare(void);
+
+    /// measure one case
+    void Measure(const CMicroBenchCase& bcase);
+
+    /// time of n executions in seconds
+    static double Execute(MICRO_BENCH_FCE fce,long n);
+};
+
+// -----------------------------------------------------------------------------
+
+#endif
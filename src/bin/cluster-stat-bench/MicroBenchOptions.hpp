@@ -0,0 +1,123 @@
+#ifndef ClusterStatMicroBenchOptionsH
+#define ClusterStatMicroBenchOptionsH
+// =============================================================================
+// cluster-stat-bench
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SimpleOptions.hpp>
+#include <StatMainHeader.hpp>
+
+//------------------------------------------------------------------------------
+
+class CMicroBenchOptions : public CSimpleOptions {
+public:
+    // constructor - tune option setup
+    CMicroBenchOptions(void);
+
+    // program name and description -----------------------------------------------
+    CSO_PROG_NAME_BEGIN
+    "cluster-stat-microbench"
+    CSO_PROG_NAME_END
+
+    CSO_PROG_DESC_BEGIN
+    "The program measures costs of datagram construction, copying, validation and serialization."
+    CSO_PROG_DESC_END
+
+    CSO_PROG_VERS_BEGIN
+    StatBuildVersion
+    CSO_PROG_VERS_END
+
+    // list of all options and arguments ------------------------------------------
+    CSO_LIST_BEGIN
+    // options ------------------------------
+    CSO_OPT(int,Time)
+    CSO_OPT(int,Repeats)
+    CSO_OPT(CSmallString,Filter)
+    CSO_OPT(bool,Help)
+    CSO_OPT(bool,Version)
+    CSO_OPT(bool,Verbose)
+    CSO_LIST_END
+
+    CSO_MAP_BEGIN
+    // description of options -----------------------------------------------------
+    CSO_MAP_OPT(int,                            /* option type */
+                Time,                           /* option name */
+                200,                          /* default value */
+                false,                          /* is option mandatory */
+                't',                           /* short option name */
+                "time",                      /* long option name */
+                "MS",                           /* parametr name */
+                "minimum duration (in milliseconds) of one measurement")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                            /* option type */
+                Repeats,                           /* option name */
+                5,                          /* default value */
+                false,                          /* is option mandatory */
+                'r',                           /* short option name */
+                "repeats",                      /* long option name */
+                "NUMBER",                           /* parametr name */
+                "number of measurements of each case, the median and minimum are reported")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(CSmallString,                   /* option type */
+                Filter,                           /* option name */
+                NULL,                          /* default value */
+                false,                          /* is option mandatory */
+                'f',                           /* short option name */
+                "filter",                      /* long option name */
+                "TEXT",                           /* parametr name */
+                "run only cases containing the text in their names")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Verbose,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                'v',                           /* short option name */
+                "verbose",                      /* long option name */
+                NULL,                           /* parametr name */
+                "increase output verbosity")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Version,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                '\0',                           /* short option name */
+                "version",                      /* long option name */
+                NULL,                           /* parametr name */
+                "output version information and exit")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Help,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                'h',                           /* short option name */
+                "help",                      /* long option name */
+                NULL,                           /* parametr name */
+                "display this help and exit")   /* option description */
+    CSO_MAP_END
+
+    // final operation with options ------------------------------------------------
+private:
+    virtual int CheckOptions(void);
+    virtual int FinalizeOptions(void);
+    virtual int CheckArguments(void);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
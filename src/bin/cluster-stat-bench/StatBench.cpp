@@ -0,0 +1,365 @@
+// =============================================================================
+// cluster-stat-bench
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <StatBench.hpp>
+#include <FCGILoad.hpp>
+#include <ErrorSystem.hpp>
+#include <Metrics.hpp>
+#include <unistd.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+
+//------------------------------------------------------------------------------
+
+CStatBench StatBench;
+
+MAIN_ENTRY_OBJECT(StatBench)
+
+using namespace std;
+using namespace boost;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CStatBench::CStatBench(void)
+{
+    Terminated = false;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+int CStatBench::Init(int argc, char* argv[])
+{
+    // encode program options, all check procedures are done inside of CABFIntOpts
+    int result = Options.ParseCmdLine(argc,argv);
+
+    // should we exit or was it error?
+    if( result != SO_CONTINUE ) return(result);
+
+    // attach verbose stream to terminal stream and set desired verbosity level
+    vout.Attach(Console);
+    if( Options.GetOptVerbose() ) {
+        vout.Verbosity(CVerboseStr::high);
+    } else {
+        vout.Verbosity(CVerboseStr::low);
+    }
+
+    // phases and actions
+    vector<string> items;
+    string clients = string(Options.GetOptClients());
+    split(items,clients,is_any_of(","),token_compress_on);
+    for(size_t i=0; i < items.size(); i++){
+        int num = atoi(items[i].c_str());
+        if( num > 0 ) Clients.push_back(num);
+    }
+
+    string actions = string(Options.GetOptActions());
+    split(items,actions,is_any_of(","),token_compress_on);
+    for(size_t i=0; i < items.size(); i++){
+        if( items[i].empty() == false ) Actions.push_back(items[i]);
+    }
+
+    return(SO_CONTINUE);
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatBench::Run(void)
+{
+    // CtrlC signal
+    signal(SIGINT,CtrlCSignalHandler);
+    signal(SIGTERM,CtrlCSignalHandler);
+
+    vout << low;
+    vout << "# ==============================================================================" << endl;
+    vout << "# cluster-stat-bench" << endl;
+    vout << "# ==============================================================================" << endl;
+    vout << "# Server                   = " << Options.GetArgServerName() << endl;
+    vout << "# Stat Port                = " << Options.GetOptPort() << endl;
+    vout << "# FCGI Port                = " << Options.GetOptFCGIPort() << endl;
+    vout << "# Virtual nodes            = " << Options.GetOptNodes() << endl;
+    vout << "# Update interval [s]      = " << Options.GetOptInterval() << endl;
+    vout << "# Session churn [%]        = " << Options.GetOptChurn() << endl;
+    vout << "# Legacy (v3) datagrams    = " << bool_to_str(Options.GetOptLegacy()) << endl;
+    vout << "# Phase duration [s]       = " << Options.GetOptDuration() << endl;
+    vout << "# FCGI clients             = " << Options.GetOptClients() << endl;
+    vout << "# FCGI actions             = " << Options.GetOptActions() << endl;
+    vout << endl;
+
+    if( Replay.Init(Options.GetArgServerName(),Options.GetOptPort(),Options.GetOptNodes(),
+                    Options.GetOptInterval(),Options.GetOptChurn(),Options.GetOptLegacy()) == false ){
+        ES_ERROR("unable to init datagram replay");
+        return(false);
+    }
+
+    if( Client.SetServer(Options.GetArgServerName(),Options.GetOptFCGIPort()) == false ){
+        ES_ERROR("unable to init FastCGI client");
+        return(false);
+    }
+
+    CServerMetrics before;
+    CServerMetrics after;
+    bool server_metrics = ReadServerMetrics(before);
+    if( server_metrics == false ){
+        ES_WARNING("server metrics are not available - only the client side is reported");
+    }
+
+    double start = CMetrics::GetTime();
+    if( Replay.StartThread() == false ){
+        ES_ERROR("unable to start datagram replay");
+        return(false);
+    }
+
+    if( Clients.empty() ){
+        Wait(Options.GetOptDuration());
+    }
+    for(size_t i=0; (i < Clients.size()) && (Terminated == false); i++){
+        RunPhase(Clients[i]);
+    }
+
+    Replay.TerminateThread();
+    Replay.WaitForThread();
+    double elapsed = CMetrics::GetTime() - start;
+
+    // let the server process queued datagrams
+    if( server_metrics ){
+        sleep(1);
+        server_metrics = ReadServerMetrics(after);
+    }
+
+    PrintReplayStatistics(elapsed,server_metrics,before,after);
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void CStatBench::Finalize(void)
+{
+    if( Options.GetOptVerbose() || ErrorSystem.IsError() ) {
+        ErrorSystem.PrintErrors(stderr);
+        fprintf(stderr,"\n");
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CStatBench::CtrlCSignalHandler(int signal)
+{
+    StatBench.Terminated = true;
+}
+
+//------------------------------------------------------------------------------
+
+void CStatBench::Wait(int duration)
+{
+    for(int i=0; (i < duration) && (Terminated == false); i++){
+        sleep(1);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CStatBench::RunPhase(int clients)
+{
+    vector<CFCGILoadPtr> loads;
+
+    double start = CMetrics::GetTime();
+    for(int i=0; i < clients; i++){
+        CFCGILoadPtr load(new CFCGILoad);
+        load->Init(Client,Actions,Options.GetOptUser(),i);
+        if( load->StartThread() == false ){
+            ES_ERROR("unable to start FastCGI client");
+            break;
+        }
+        loads.push_back(load);
+    }
+
+    Wait(Options.GetOptDuration());
+
+    for(size_t i=0; i < loads.size(); i++){
+        loads[i]->TerminateThread();
+    }
+    for(size_t i=0; i < loads.size(); i++){
+        loads[i]->WaitForThread();
+    }
+    double elapsed = CMetrics::GetTime() - start;
+
+    // merge results
+    vector<CFCGIActionStat> results(Actions.size());
+    for(size_t i=0; i < loads.size(); i++){
+        const vector<CFCGIActionStat>& res = loads[i]->GetResults();
+        for(size_t k=0; k < res.size(); k++){
+            results[k].Merge(res[k]);
+        }
+    }
+
+    vout << low;
+    vout << "# FCGI clients = " << clients << ", elapsed time = " << fixed << setprecision(1) << elapsed << " s" << endl;
+    vout << "# action           requests   errors  rate[1/s]   p50[ms]   p90[ms]   p99[ms]   max[ms]" << endl;
+    vout << "# --------------- --------- -------- ---------- --------- --------- --------- ---------" << endl;
+    for(size_t k=0; k < results.size(); k++){
+        CFCGIActionStat& res = results[k];
+        sort(res.Latencies.begin(),res.Latencies.end());
+        vout << "  " << left << setw(15) << Actions[k] << right;
+        vout << " " << setw(9) << res.Latencies.size();
+        vout << " " << setw(8) << res.Errors;
+        vout << " " << setw(10) << setprecision(1) << res.Latencies.size() / elapsed;
+        vout << setprecision(3);
+        vout << " " << setw(9) << res.GetPercentile(50) * 1.0e3;
+        vout << " " << setw(9) << res.GetPercentile(90) * 1.0e3;
+        vout << " " << setw(9) << res.GetPercentile(99) * 1.0e3;
+        vout << " " << setw(9) << res.GetPercentile(100) * 1.0e3;
+        vout << endl;
+    }
+    vout << endl;
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatBench::ReadServerMetrics(CServerMetrics& metrics)
+{
+    metrics.clear();
+
+    CFCGIParams params;
+    params["REQUEST_METHOD"]    = "GET";
+    params["SCRIPT_NAME"]       = "/cluster-stat";
+    params["SERVER_NAME"]       = "localhost";
+    params["SERVER_PORT"]       = "80";
+    params["QUERY_STRING"]      = "action=metrics";
+
+    int     status;
+    string  body;
+    if( (Client.Request(params,status,body) == false) || (status != 200) ) return(false);
+
+    // name{labels} value
+    stringstream str(body);
+    string line;
+    while( getline(str,line) ){
+        if( line.empty() || (line[0] == '#') ) continue;
+        size_t pos = line.rfind(' ');
+        if( pos == string::npos ) continue;
+        metrics[line.substr(0,pos)] = atof(line.c_str()+pos+1);
+    }
+
+    return(metrics.empty() == false);
+}
+
+//------------------------------------------------------------------------------
+
+void CStatBench::PrintReplayStatistics(double elapsed,bool server_metrics,
+                                       const CServerMetrics& before,const CServerMetrics& after)
+{
+    unsigned long sent = Replay.Datagrams.Get() + Replay.Heartbeats.Get();
+
+    vout << low;
+    vout << "# Datagram replay ------------------------------------------------------------" << endl;
+    vout << "# Elapsed time [s]                     = " << fixed << setprecision(1) << elapsed << endl;
+    vout << "# Number of update rounds              = " << Replay.Rounds.Get() << endl;
+    vout << "# Number of sent datagrams             = " << Replay.Datagrams.Get() << endl;
+    vout << "# Number of sent heartbeats            = " << Replay.Heartbeats.Get() << endl;
+    vout << "# Number of send errors                = " << Replay.SendErrors.Get() << endl;
+    vout << "# Sent packets per second              = " << setprecision(1) << sent / elapsed << endl;
+    vout << "# Sent kilobytes per second            = " << setprecision(1) << Replay.Bytes.Get() / elapsed / 1024.0 << endl;
+
+    if( server_metrics == false ){
+        vout << endl;
+        return;
+    }
+
+    // server side - counters include packets of other clients if any
+    CServerMetrics delta;
+    CServerMetrics::const_iterator it = after.begin();
+    CServerMetrics::const_iterator ie = after.end();
+    while( it != ie ){
+        CServerMetrics::const_iterator bt = before.find(it->first);
+        delta[it->first] = it->second - ((bt != before.end()) ? bt->second : 0.0);
+        it++;
+    }
+
+    double accepted = delta["clusterstat_datagrams_accepted_total"];
+    vout << "# Number of received packets (server)  = " << setprecision(0) << delta["clusterstat_datagrams_total"] << endl;
+    vout << "# Number of accepted packets (server)  = " << accepted << endl;
+    vout << "# Number of kernel-dropped packets     = " << delta["clusterstat_datagrams_kernel_dropped_total"] << endl;
+
+    string prefix = "clusterstat_datagrams_dropped_total{reason=\"";
+    it = delta.begin();
+    ie = delta.end();
+    while( it != ie ){
+        if( it->first.compare(0,prefix.size(),prefix) == 0 ){
+            string reason = it->first.substr(prefix.size(),it->first.size() - prefix.size() - 2);
+            vout << "# Dropped packets (" << left << setw(14) << reason + ")" << right << "     = " << it->second << endl;
+        }
+        it++;
+    }
+
+    if( sent > 0 ){
+        double drop_rate = 100.0 * (sent - accepted) / sent;
+        if( drop_rate < 0 ) drop_rate = 0;
+        vout << "# Drop rate [%]                        = " << setprecision(2) << drop_rate << endl;
+    }
+    vout << "# Accepted packets per second          = " << setprecision(1) << accepted / elapsed << endl;
+
+    // registry contention - waits up to the first bucket bound are uncontended locks
+    string name = "clusterstat_registry_lock_wait_seconds";
+    double locks = delta[name + "_count"];
+    if( locks > 0 ){
+        vector< pair<double,double> > buckets;  // bound, cumulative count
+        prefix = name + "_bucket{le=\"";
+        it = delta.begin();
+        ie = delta.end();
+        while( it != ie ){
+            if( (it->first.compare(0,prefix.size(),prefix) == 0) && (it->first.find("+Inf") == string::npos) ){
+                buckets.push_back(make_pair(atof(it->first.c_str()+prefix.size()),it->second));
+            }
+            it++;
+        }
+        sort(buckets.begin(),buckets.end());
+
+        vout << "# Registry lock acquisitions           = " << setprecision(0) << locks << endl;
+        vout << "# Registry lock wait, mean [us]        = " << setprecision(3) << delta[name + "_sum"] / locks * 1.0e6 << endl;
+        if( buckets.empty() == false ){
+            double contended = locks - buckets[0].second;
+            vout << "# Registry lock waits > " << setw(5) << setprecision(0) << buckets[0].first * 1.0e6 << " us [%]   = "
+                 << setprecision(2) << 100.0 * contended / locks << endl;
+            for(size_t i=0; i < buckets.size(); i++){
+                if( buckets[i].second >= 0.99 * locks ){
+                    vout << "# Registry lock wait, p99 [us]         <= " << setprecision(0) << buckets[i].first * 1.0e6 << endl;
+                    break;
+                }
+            }
+        }
+    }
+    vout << endl;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,90 @@
+#ifndef ClusterStatBenchH
+#define ClusterStatBenchH
+// =============================================================================
+// cluster-stat-bench
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <VerboseStr.hpp>
+#include <TerminalStr.hpp>
+#include <BenchOptions.hpp>
+#include <DatagramReplay.hpp>
+#include <FCGIClient.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+
+typedef std::map<std::string,double>    CServerMetrics;
+
+// -----------------------------------------------------------------------------
+
+//! load generator and benchmark for cluster-stat-server
+/*!
+  datagrams of virtual nodes are replayed during the whole run, FastCGI
+  requests are sent in phases with increasing number of concurrent clients;
+  ingestion counters of the server are read from the metrics action before
+  and after the run
+*/
+
+class CStatBench {
+public:
+// constructor and destructors -------------------------------------------------
+    CStatBench(void);
+
+// main methods ----------------------------------------------------------------
+    /// init options
+    int Init(int argc,char* argv[]);
+
+    /// main part of program
+    bool Run(void);
+
+    /// finalize
+    void Finalize(void);
+
+// section of private data -----------------------------------------------------
+private:
+    CStatBenchOptions           Options;
+    CTerminalStr                Console;
+    CVerboseStr                 vout;
+    bool                        Terminated;
+    CDatagramReplay             Replay;
+    CFCGIClient                 Client;
+    std::vector<int>            Clients;
+    std::vector<std::string>    Actions;
+
+    /// run one phase with given number of FastCGI clients
+    void RunPhase(int clients);
+
+    /// wait for given time or termination
+    void Wait(int duration);
+
+    /// read server metrics, false if they are not available
+    bool ReadServerMetrics(CServerMetrics& metrics);
+
+    /// print ingestion summary
+    void PrintReplayStatistics(double elapsed,bool server_metrics,
+                               const CServerMetrics& before,const CServerMetrics& after);
+
+    static void CtrlCSignalHandler(int signal);
+};
+
+// -----------------------------------------------------------------------------
+
+#endif
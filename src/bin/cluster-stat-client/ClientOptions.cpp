@@ -19,6 +19,7 @@
 // =============================================================================
 
 #include <ClientOptions.hpp>
+#include <stdio.h>
 
 //==============================================================================
 //------------------------------------------------------------------------------
@@ -33,6 +34,28 @@ CStatClientOptions::CStatClientOptions(void)
 
 int CStatClientOptions::CheckOptions(void)
 {
+    // zero interval means one shot update
+    if( GetOptInterval() < 0 ){
+        fprintf(stderr,"\n%s: interval must not be negative\n",(const char*)GetProgramName());
+        return(SO_USER_ERROR);
+    }
+    // zero refresh means full updates only
+    if( (GetOptRefresh() < 0) || (GetOptRefresh() >= 180) ){
+        fprintf(stderr,"\n%s: refresh must be in the range 0-179 s\n",(const char*)GetProgramName());
+        return(SO_USER_ERROR);
+    }
+    // keepalive is used only in the monitor mode
+    if( GetOptMonitor() == false ) return(SO_CONTINUE);
+
+    // nodes without any update for 180 s are shown down
+    if( (GetOptKeepAlive() <= 0) || (GetOptKeepAlive() >= 180) ){
+        fprintf(stderr,"\n%s: keepalive must be in the range 1-179 s\n",(const char*)GetProgramName());
+        return(SO_USER_ERROR);
+    }
+    if( (GetOptRefresh() > 0) && (GetOptRefresh() < GetOptKeepAlive()) ){
+        fprintf(stderr,"\n%s: refresh must not be shorter than keepalive (or zero) in the monitor mode\n",(const char*)GetProgramName());
+        return(SO_USER_ERROR);
+    }
     return(SO_CONTINUE);
 }
 
@@ -50,6 +50,9 @@ public:
     // options ------------------------------
     CSO_OPT(int,Port)
     CSO_OPT(int,Interval)
+    CSO_OPT(bool,Monitor)
+    CSO_OPT(int,KeepAlive)
+    CSO_OPT(int,Refresh)
     CSO_OPT(bool,Shutdown)
     CSO_OPT(bool,Help)
     CSO_OPT(bool,Version)
@@ -83,6 +86,33 @@ public:
                 "TIME",                           /* parametr name */
                 "delay (in seconds) between regular node status updates (zero value means one shot update)")   /* option description */
     //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Monitor,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                'm',                           /* short option name */
+                "monitor",                      /* long option name */
+                NULL,                           /* parametr name */
+                "send node status immediately after a session change, regular updates are replaced by keep-alive updates")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                            /* option type */
+                KeepAlive,                           /* option name */
+                60,                          /* default value */
+                false,                          /* is option mandatory */
+                'k',                           /* short option name */
+                "keepalive",                      /* long option name */
+                "TIME",                           /* parametr name */
+                "delay (in seconds) between keep-alive updates in the monitor mode (it must be shorter than 180 s and not longer than refresh unless refresh is zero)")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                            /* option type */
+                Refresh,                           /* option name */
+                60,                           /* default value */
+                false,                          /* is option mandatory */
+                'r',                           /* short option name */
+                "refresh",                      /* long option name */
+                "TIME",                           /* parametr name */
+                "maximum delay (in seconds) between full node status updates, short heartbeats are sent if the status is unchanged (it must be shorter than 180 s, zero value means full updates only)")   /* option description */
+    //----------------------------------------------------------------------
     CSO_MAP_OPT(bool,                           /* option type */
                 Shutdown,                        /* option name */
                 false,                          /* default value */
@@ -0,0 +1,383 @@
+// =============================================================================
+// cluster-stat-client
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SessionCollector.hpp>
+#include <ErrorSystem.hpp>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <pwd.h>
+#include <dirent.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <boost/algorithm/string.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+using namespace boost;
+using namespace boost::algorithm;
+
+//------------------------------------------------------------------------------
+
+#define SYSTEMD_LIB_NAME    "libsystemd.so.0"
+#define VNCSESSION_CMD      "/opt/rdsk-full-gui/sbin/vncsession "
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CSessionCollector::CSessionCollector(void)
+{
+    NativeMode = false;
+
+    sd_get_sessions = NULL;
+    sd_session_get_uid = NULL;
+    sd_session_get_type = NULL;
+    sd_session_get_service = NULL;
+    sd_session_get_tty = NULL;
+    sd_session_is_remote = NULL;
+    sd_pid_get_session = NULL;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CSessionCollector::Init(void)
+{
+    NativeMode = InitSymbols();
+    if( NativeMode == false ){
+        ES_WARNING("sd-login API is not available - using /bin/loginctl");
+    }
+    return(NativeMode);
+}
+
+//------------------------------------------------------------------------------
+
+bool CSessionCollector::InitSymbols(void)
+{
+    if( SystemdLib.Open(SYSTEMD_LIB_NAME) == false ){
+        ES_ERROR("unable to load " SYSTEMD_LIB_NAME);
+        return(false);
+    }
+
+    // load symbols
+    bool status = true;
+    sd_get_sessions = (SD_GET_SESSIONS)SystemdLib.GetProcAddress("sd_get_sessions");
+    if( sd_get_sessions == NULL ){
+        ES_ERROR("unable to bind to sd_get_sessions");
+        status = false;
+    }
+    sd_session_get_uid = (SD_SESSION_GET_UID)SystemdLib.GetProcAddress("sd_session_get_uid");
+    if( sd_session_get_uid == NULL ){
+        ES_ERROR("unable to bind to sd_session_get_uid");
+        status = false;
+    }
+    sd_session_get_type = (SD_SESSION_GET_TYPE)SystemdLib.GetProcAddress("sd_session_get_type");
+    if( sd_session_get_type == NULL ){
+        ES_ERROR("unable to bind to sd_session_get_type");
+        status = false;
+    }
+    sd_session_get_service = (SD_SESSION_GET_SERVICE)SystemdLib.GetProcAddress("sd_session_get_service");
+    if( sd_session_get_service == NULL ){
+        ES_ERROR("unable to bind to sd_session_get_service");
+        status = false;
+    }
+    sd_session_get_tty = (SD_SESSION_GET_TTY)SystemdLib.GetProcAddress("sd_session_get_tty");
+    if( sd_session_get_tty == NULL ){
+        ES_ERROR("unable to bind to sd_session_get_tty");
+        status = false;
+    }
+    sd_session_is_remote = (SD_SESSION_IS_REMOTE)SystemdLib.GetProcAddress("sd_session_is_remote");
+    if( sd_session_is_remote == NULL ){
+        ES_ERROR("unable to bind to sd_session_is_remote");
+        status = false;
+    }
+    sd_pid_get_session = (SD_PID_GET_SESSION)SystemdLib.GetProcAddress("sd_pid_get_session");
+    if( sd_pid_get_session == NULL ){
+        ES_ERROR("unable to bind to sd_pid_get_session");
+        status = false;
+    }
+    return(status);
+}
+
+//------------------------------------------------------------------------------
+
+bool CSessionCollector::IsNative(void)
+{
+    return(NativeMode);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CSessionCollector::GetSessions(std::list<CUserSession>& sessions)
+{
+    sessions.clear();
+    if( NativeMode ){
+        GetSessionsNative(sessions);
+    } else {
+        GetSessionsLoginCtl(sessions);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CSessionCollector::GetSessionsNative(std::list<CUserSession>& sessions)
+{
+    char** p_sids = NULL;
+    int    nsids = sd_get_sessions(&p_sids);
+    if( nsids < 0 ){
+        CSmallString error;
+        error << "unable to get list of sessions (" << strerror(-nsids) << ")";
+        ES_ERROR(error);
+        return;
+    }
+
+    CSmallString active_tty = GetActiveTTY();
+    bool         remote = false;
+
+    for(int i=0; i < nsids; i++){
+        const char* p_sid = p_sids[i];
+        uid_t       uid;
+        CUserSession ses;
+
+        if( (sd_session_get_uid(p_sid,&uid) >= 0) && SetUser(ses,getpwuid(uid)) ){
+            ses.SessionID = p_sid;
+
+            char* p_str = NULL;
+            if( sd_session_get_type(p_sid,&p_str) >= 0 ){
+                if( strcmp(p_str,"x11") == 0 ) ses.X11 = true;
+                if( strcmp(p_str,"wayland") == 0 ) ses.Wayland = true;
+                free(p_str);
+            }
+
+            p_str = NULL;
+            if( sd_session_get_service(p_sid,&p_str) >= 0 ){
+                if( strncmp(p_str,"tigervnc",8) == 0 ) ses.RDSK = true;
+                free(p_str);
+            }
+
+            p_str = NULL;
+            if( sd_session_get_tty(p_sid,&p_str) >= 0 ){
+                if( (active_tty != NULL) && (active_tty == p_str) ) ses.ActiveTTY = true;
+                free(p_str);
+            }
+
+            ses.Remote = sd_session_is_remote(p_sid) > 0;
+            if( ses.Remote ) remote = true;
+
+            sessions.push_back(ses);
+        }
+        free(p_sids[i]);
+    }
+    free(p_sids);
+
+    // Xvnc and vncsession are relevant only for remote sessions
+    if( remote ) ScanSessionProcesses(sessions);
+}
+
+//------------------------------------------------------------------------------
+
+void CSessionCollector::ScanSessionProcesses(std::list<CUserSession>& sessions)
+{
+    std::map<std::string,CUserSession*> remote;
+
+    std::list<CUserSession>::iterator   it = sessions.begin();
+    std::list<CUserSession>::iterator   ie = sessions.end();
+
+    while( it != ie ){
+        if( it->Remote ) remote[it->SessionID] = &(*it);
+        it++;
+    }
+
+    DIR* p_dir = opendir("/proc");
+    if( p_dir == NULL ){
+        ES_ERROR("unable to open /proc");
+        return;
+    }
+
+    struct dirent* p_ent;
+    while( (p_ent = readdir(p_dir)) != NULL ){
+        char* p_end = NULL;
+        long  pid = strtol(p_ent->d_name,&p_end,10);
+        if( (p_end == p_ent->d_name) || (*p_end != '\0') ) continue;   // not a process
+
+        char* p_sid = NULL;
+        if( sd_pid_get_session(pid,&p_sid) < 0 ) continue;
+        std::map<std::string,CUserSession*>::iterator sit = remote.find(p_sid);
+        free(p_sid);
+        if( sit == remote.end() ) continue;
+
+        // read command line
+        CSmallString path;
+        path << "/proc/" << p_ent->d_name << "/cmdline";
+        FILE* p_fin = fopen(path,"r");
+        if( p_fin == NULL ) continue;       // the process has already finished
+        char   buffer[BUFFER_LEN];
+        size_t len = fread(buffer,1,BUFFER_LEN-1,p_fin);
+        fclose(p_fin);
+        for(size_t i=0; i < len; i++){
+            if( buffer[i] == '\0' ) buffer[i] = ' ';
+        }
+        buffer[len] = '\0';
+
+        std::string cmdline(buffer);
+        if( cmdline.find("Xvnc") != std::string::npos ) sit->second->VNC = true;
+        // cmd user display
+        DecodeVNCSession(*sit->second,cmdline,3);
+    }
+
+    closedir(p_dir);
+}
+
+//------------------------------------------------------------------------------
+
+void CSessionCollector::GetSessionsLoginCtl(std::list<CUserSession>& sessions)
+{
+    FILE* p_sf = popen("/bin/loginctl --no-legend --no-pager list-sessions","r");
+
+    CSmallString buffer;
+    while( (p_sf != NULL) && (buffer.ReadLineFromFile(p_sf,true,true)) ) {
+        stringstream str(buffer.GetBuffer());
+        string sid;
+        string uid;
+        string user;
+        string seat;
+        string tty;
+        str >> sid >> uid >> user >> seat >> tty;
+        if( ! (sid .empty() || uid.empty() || user.empty()) ){
+            CUserSession ses;
+            if( SetUser(ses,getpwnam(user.c_str())) ){
+                ses.SessionID = sid;
+                sessions.push_back(ses);
+            }
+        }
+    }
+    if( p_sf ) pclose(p_sf);
+
+    // load active tty
+    CSmallString active_tty;
+    CSmallString tty = GetActiveTTY();
+    if( tty != NULL ){
+        active_tty << "TTY=" << tty;
+    }
+
+    // deep seesion investigation
+    std::list<CUserSession>::iterator   it = sessions.begin();
+    std::list<CUserSession>::iterator   ie = sessions.end();
+
+    while(it != ie){
+        CUserSession& ses = *it;
+        CSmallString cmd;
+
+        cmd << "/bin/loginctl show-session " << ses.SessionID;
+        FILE* p_sf = popen(cmd,"r");
+        if( p_sf ){
+            CSmallString buffer;
+            while( buffer.ReadLineFromFile(p_sf,true,true) ){
+                if( buffer.FindSubString("Type=x11") != -1 ) ses.X11 = true;
+                if( buffer.FindSubString("Type=wayland") != -1 ) ses.Wayland = true;
+                if( buffer.FindSubString("Service=tigervnc") != -1 ) ses.RDSK = true;
+                if( buffer.FindSubString("Remote=yes") != -1 ) ses.Remote = true;
+                if( (active_tty != NULL) && (buffer.FindSubString(active_tty) != -1) ) ses.ActiveTTY = true;
+            }
+            pclose(p_sf);
+        }
+
+        cmd = NULL;
+        cmd << "/bin/loginctl session-status " << ses.SessionID;
+        p_sf = popen(cmd,"r");
+        if( p_sf ){
+            CSmallString buffer;
+            buffer.SetLength(BUFFER_LEN);   // +1 for \0 is added internally
+            while( buffer.ReadLineFromFile(p_sf,true,true) ){
+                if( buffer.FindSubString("Xvnc") != -1 ) ses.VNC = true;
+                // tree pid cmd user display
+                DecodeVNCSession(ses,string(buffer.GetBuffer()),4);
+            }
+            pclose(p_sf);
+        }
+
+        it++;
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CSessionCollector::SetUser(CUserSession& ses,struct passwd* p_pwd)
+{
+    // only regular users
+    if( (p_pwd == NULL) || (p_pwd->pw_uid <= 1000) ) return(false);
+
+    CSmallString name;
+    std::string stext = std::string(p_pwd->pw_gecos);
+    vector<string>  words;
+    split(words,stext,is_any_of(","));
+    if( words.size() >= 1 ){
+        name = words[0];
+    }
+    strncpy(ses.UserName,name,NAME_SIZE-1);
+    strncpy(ses.LoginName,p_pwd->pw_name,NAME_SIZE-1);
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void CSessionCollector::DecodeVNCSession(CUserSession& ses,const std::string& cmdline,size_t nwords)
+{
+    // the terminal space in the string is important
+    if( cmdline.find(VNCSESSION_CMD) == std::string::npos ) return;
+
+    std::string stext = cmdline;
+    trim(stext);
+    vector<string>  words;
+    split(words,stext,is_any_of(" "),token_compress_on);
+    if( words.size() == nwords ){
+        ses.DisplayID = words[nwords-1];
+    }
+}
+
+//------------------------------------------------------------------------------
+
+CSmallString CSessionCollector::GetActiveTTY(void)
+{
+    CSmallString active_tty;
+    FILE* p_tty0 = fopen("/sys/class/tty/tty0/active","r");
+    if( p_tty0 ){
+        active_tty.ReadLineFromFile(p_tty0,true,false);
+        fclose(p_tty0);
+    }
+    return(active_tty);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,100 @@
+#ifndef SessionCollectorH
+#define SessionCollectorH
+// =============================================================================
+// cluster-stat-client
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <DynamicPackage.hpp>
+#include <StatDatagram.hpp>
+#include <sys/types.h>
+#include <list>
+
+// -----------------------------------------------------------------------------
+
+typedef int (*SD_GET_SESSIONS)(char***);
+typedef int (*SD_SESSION_GET_UID)(const char*,uid_t*);
+typedef int (*SD_SESSION_GET_TYPE)(const char*,char**);
+typedef int (*SD_SESSION_GET_SERVICE)(const char*,char**);
+typedef int (*SD_SESSION_GET_TTY)(const char*,char**);
+typedef int (*SD_SESSION_IS_REMOTE)(const char*);
+typedef int (*SD_PID_GET_SESSION)(pid_t,char**);
+
+// -----------------------------------------------------------------------------
+
+//! collect user sessions from systemd-logind
+/*!
+  sessions are read in-process via the sd-login API (libsystemd is loaded
+  at runtime), loginctl is used as a fallback if the library is not available
+*/
+
+class CSessionCollector {
+public:
+// constructor -----------------------------------------------------------------
+    CSessionCollector(void);
+
+// init collector subsystem ----------------------------------------------------
+    //! load sd-login symbols, false means that loginctl is used
+    bool Init(void);
+
+    //! is sd-login API used?
+    bool IsNative(void);
+
+// execution -------------------------------------------------------------------
+    //! get list of sessions of regular users
+    void GetSessions(std::list<CUserSession>& sessions);
+
+// section of private data -----------------------------------------------------
+private:
+    CDynamicPackage SystemdLib;
+    bool            NativeMode;
+
+    // init symbols
+    bool InitSymbols(void);
+
+    // sd-login API
+    void GetSessionsNative(std::list<CUserSession>& sessions);
+
+    // fallback - /bin/loginctl
+    void GetSessionsLoginCtl(std::list<CUserSession>& sessions);
+
+    // scan processes of remote sessions (Xvnc, vncsession)
+    void ScanSessionProcesses(std::list<CUserSession>& sessions);
+
+    // decode user, only regular users are accepted
+    static bool SetUser(CUserSession& ses,struct passwd* p_pwd);
+
+    // decode display id from vncsession command line
+    static void DecodeVNCSession(CUserSession& ses,const std::string& cmdline,size_t nwords);
+
+    // get active tty
+    static CSmallString GetActiveTTY(void);
+
+    // sd-login API symbols
+    SD_GET_SESSIONS         sd_get_sessions;
+    SD_SESSION_GET_UID      sd_session_get_uid;
+    SD_SESSION_GET_TYPE     sd_session_get_type;
+    SD_SESSION_GET_SERVICE  sd_session_get_service;
+    SD_SESSION_GET_TTY      sd_session_get_tty;
+    SD_SESSION_IS_REMOTE    sd_session_is_remote;
+    SD_PID_GET_SESSION      sd_pid_get_session;
+};
+
+// -----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,172 @@
+// =============================================================================
+// cluster-stat-client
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SessionMonitor.hpp>
+#include <ErrorSystem.hpp>
+#include <sys/inotify.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+//------------------------------------------------------------------------------
+
+#define SESSIONS_DIR    "/run/systemd/sessions"
+#define ACTIVE_TTY      "/sys/class/tty/tty0/active"
+
+// events arriving within this period (in ms) are merged into one update
+#define SETTLE_TIME     250
+#define MAX_SETTLE_TIME 2000
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CSessionMonitor::CSessionMonitor(void)
+{
+    INotifyFD = -1;
+    TTYFD = -1;
+}
+
+//------------------------------------------------------------------------------
+
+CSessionMonitor::~CSessionMonitor(void)
+{
+    Close();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CSessionMonitor::Open(void)
+{
+    Close();
+
+    INotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if( INotifyFD == -1 ){
+        CSmallString error;
+        error << "unable to init inotify (" << strerror(errno) << ")";
+        ES_ERROR(error);
+    } else {
+        // logind writes session files into temporary files and renames them
+        if( inotify_add_watch(INotifyFD,SESSIONS_DIR,IN_CREATE|IN_DELETE|IN_MOVED_TO|IN_MOVED_FROM|IN_CLOSE_WRITE) == -1 ){
+            CSmallString error;
+            error << "unable to watch '" << SESSIONS_DIR << "' (" << strerror(errno) << ")";
+            ES_ERROR(error);
+            close(INotifyFD);
+            INotifyFD = -1;
+        }
+    }
+
+    // sysfs attributes must be read before they can be polled
+    TTYFD = open(ACTIVE_TTY,O_RDONLY | O_CLOEXEC);
+    if( TTYFD != -1 ){
+        char buffer[64];
+        if( read(TTYFD,buffer,sizeof(buffer)) < 0 ){
+            close(TTYFD);
+            TTYFD = -1;
+        }
+    }
+
+    return( (INotifyFD != -1) || (TTYFD != -1) );
+}
+
+//------------------------------------------------------------------------------
+
+void CSessionMonitor::Close(void)
+{
+    if( INotifyFD != -1 ) close(INotifyFD);
+    INotifyFD = -1;
+    if( TTYFD != -1 ) close(TTYFD);
+    TTYFD = -1;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CSessionMonitor::WaitForChange(int timeout)
+{
+    if( WaitForEvents(timeout*1000) == false ) return(false);
+
+    // logind usually rewrites several files at once - let it settle
+    int settle = 0;
+    while( (settle < MAX_SETTLE_TIME) && WaitForEvents(SETTLE_TIME) ){
+        settle += SETTLE_TIME;
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CSessionMonitor::WaitForEvents(int timeout)
+{
+    struct pollfd fds[2];
+    int           nfds = 0;
+
+    if( INotifyFD != -1 ){
+        fds[nfds].fd = INotifyFD;
+        fds[nfds].events = POLLIN;
+        fds[nfds].revents = 0;
+        nfds++;
+    }
+    if( TTYFD != -1 ){
+        fds[nfds].fd = TTYFD;
+        fds[nfds].events = POLLPRI | POLLERR;
+        fds[nfds].revents = 0;
+        nfds++;
+    }
+
+    // poll is interrupted by SIGINT/SIGTERM
+    int ret = poll(fds,nfds,timeout);
+    if( ret <= 0 ) return(false);
+
+    DrainEvents();
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void CSessionMonitor::DrainEvents(void)
+{
+    char buffer[4096];
+
+    if( INotifyFD != -1 ){
+        while( read(INotifyFD,buffer,sizeof(buffer)) > 0 );
+    }
+
+    // re-arm sysfs notification
+    if( TTYFD != -1 ){
+        lseek(TTYFD,0,SEEK_SET);
+        if( read(TTYFD,buffer,sizeof(buffer)) < 0 ){
+            close(TTYFD);
+            TTYFD = -1;
+        }
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,65 @@
+#ifndef SessionMonitorH
+#define SessionMonitorH
+// =============================================================================
+// cluster-stat-client
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SmallString.hpp>
+
+// -----------------------------------------------------------------------------
+
+//! watch for session changes
+/*!
+  logind keeps one state file per session in /run/systemd/sessions, which is
+  rewritten on every session change (new, removed, property change);
+  the active VT is reported by /sys/class/tty/tty0/active (sysfs notification)
+*/
+
+class CSessionMonitor {
+public:
+// constructor and destructors -------------------------------------------------
+    CSessionMonitor(void);
+    ~CSessionMonitor(void);
+
+// setup -----------------------------------------------------------------------
+    //! start watching, false if no source of events is available
+    bool Open(void);
+
+    //! stop watching
+    void Close(void);
+
+// execution -------------------------------------------------------------------
+    //! wait for a change or timeout (in seconds), true if a change was detected
+    bool WaitForChange(int timeout);
+
+// section of private data -----------------------------------------------------
+private:
+    int     INotifyFD;
+    int     TTYFD;
+
+    // wait for events, timeout in ms, true if any event was received
+    bool    WaitForEvents(int timeout);
+
+    // read all pending events
+    void    DrainEvents(void);
+};
+
+// -----------------------------------------------------------------------------
+
+#endif
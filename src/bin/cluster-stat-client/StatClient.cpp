@@ -33,12 +33,17 @@
 #include <errno.h>
 #include <fnmatch.h>
 #include <StatClient.hpp>
+#include <StatPacket.hpp>
 #include <signal.h>
+#include <poll.h>
 
 //------------------------------------------------------------------------------
 
 #define MAX_NET_NAME 255
 
+// how long to wait for resync request after heartbeat (in ms)
+#define RESYNC_TIMEOUT 250
+
 //------------------------------------------------------------------------------
 
 CStatClient StatClient;
@@ -54,6 +59,9 @@ using namespace std;
 CStatClient::CStatClient(void)
 {
     Terminated = false;
+    LastStateValid = false;
+    LastStateHash = 0;
+    LastFullUpdate = 0;
 }
 
 //==============================================================================
@@ -76,6 +84,9 @@ int CStatClient::Init(int argc, char* argv[])
         vout.Verbosity(CVerboseStr::low);
     }
 
+    // sd-login or loginctl
+    Sessions.Init();
+
     return(SO_CONTINUE);
 }
 
@@ -88,29 +99,53 @@ bool CStatClient::Run(void)
     signal(SIGTERM,CtrlCSignalHandler);
 
     if( (Options.GetOptInterval() > 0) || (Options.GetOptShutdown() == false) ) {
+        // event driven updates
+        bool monitor = false;
+        if( Options.GetOptMonitor() && (Options.GetOptInterval() != 0) ){
+            monitor = Monitor.Open();
+            if( monitor == false ){
+                ES_WARNING("session monitor is not available - using regular updates");
+            }
+        }
+
         do {
-            Datagram.SetDatagram(false);
-            vout << high;
-            Datagram.PrintInfo(vout);
+            std::list<CUserSession> sessions;
+            Sessions.GetSessions(sessions);
+            Datagram.SetDatagram(sessions,false);
 
-            if( SendDataToServer(Options.GetArgServerName(),Options.GetOptPort()) == false ) {
+            if( SendNodeStatus() == false ) {
                 ES_ERROR("unable to send datagram");
                 return(false);
             }
-            if( Options.GetOptInterval() > 0 ){
+            if( monitor ){
+                if( Monitor.WaitForChange(Options.GetOptKeepAlive()) ){
+                    vout << high;
+                    vout << ">>> session change detected" << endl;
+                }
+            } else if( Options.GetOptInterval() > 0 ){
                 sleep(Options.GetOptInterval());
             }
 
         } while( (Terminated == false) && (Options.GetOptInterval() != 0) );
+
+        Monitor.Close();
     }
 
 // send termination datagram
     if( Options.GetOptShutdown() == true ) {
-        Datagram.SetDatagram(true);
+        std::list<CUserSession> sessions;   // no sessions are reported
+        Datagram.SetDatagram(sessions,true);
         vout << high;
         Datagram.PrintInfo(vout);
 
-        if( SendDataToServer(Options.GetArgServerName(),Options.GetOptPort()) == false ) {
+        char   buffer[STAT_PACKET_MAX_SIZE];
+        size_t size = Datagram.Serialize(buffer,sizeof(buffer));
+        if( size == 0 ){
+            ES_ERROR("unable to encode termination datagram");
+            return(false);
+        }
+
+        if( SendDataToServer(Options.GetArgServerName(),Options.GetOptPort(),buffer,size) == false ) {
             ES_ERROR("unable to send termination datagram");
             return(false);
         }
@@ -144,7 +179,63 @@ void CStatClient::CtrlCSignalHandler(int signal)
 
 //------------------------------------------------------------------------------
 
-bool CStatClient::SendDataToServer(const CSmallString& servername,int port)
+bool CStatClient::SendNodeStatus(void)
+{
+    CSmallTimeAndDate ctime;
+    ctime.GetActualTimeAndDate();
+    int now = ctime.GetSecondsFromBeginning();
+
+    unsigned int hash = Datagram.GetStateHash();
+
+    char    buffer[STAT_PACKET_MAX_SIZE];
+    size_t  size;
+
+    // the server already knows the state - only keep the node alive
+    if( (Options.GetOptRefresh() > 0) && LastStateValid && (hash == LastStateHash) &&
+        (now - LastFullUpdate < Options.GetOptRefresh()) ){
+        CStatHeartbeat heartbeat;
+        heartbeat.SetHeartbeat(Datagram);
+        vout << high;
+        vout << ">>> heartbeat (state unchanged)" << endl;
+        size = heartbeat.Serialize(buffer,sizeof(buffer));
+        if( size == 0 ){
+            ES_ERROR("unable to encode heartbeat");
+            return(false);
+        }
+        bool resync = false;
+        if( SendDataToServer(Options.GetArgServerName(),Options.GetOptPort(),buffer,size,&heartbeat,&resync) == false ){
+            return(false);
+        }
+        if( resync == false ) return(true);
+        // e.g. server restart or lost datagram
+        vout << ">>> server requested full update" << endl;
+    }
+
+    vout << high;
+    Datagram.PrintInfo(vout);
+
+    size = Datagram.Serialize(buffer,sizeof(buffer));
+    if( size == 0 ){
+        ES_ERROR("unable to encode datagram");
+        return(false);
+    }
+    vout << ">>> datagram size = " << size << " bytes" << endl;
+
+    if( SendDataToServer(Options.GetArgServerName(),Options.GetOptPort(),buffer,size) == false ){
+        return(false);
+    }
+
+    LastStateValid  = true;
+    LastStateHash   = hash;
+    LastFullUpdate  = now;
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatClient::SendDataToServer(const CSmallString& servername,int port,const void* p_data,size_t size,
+                                   CStatHeartbeat* p_heartbeat,bool* p_resync)
 {
     // get IP address of server ---------------------
     addrinfo*      p_addrinfo;
@@ -213,11 +304,25 @@ bool CStatClient::SendDataToServer(const CSmallString& servername,int port)
 
     // send module datagram to server
 
-    if (send(sfd, &Datagram, sizeof(Datagram), MSG_NOSIGNAL) != sizeof(Datagram)) {
+    if (send(sfd, p_data, size, MSG_NOSIGNAL) != (ssize_t)size) {
         ES_ERROR("unable to send datagram");
         exit(EXIT_FAILURE);
     }
 
+    // the server replies only if it does not know the node state
+    if( (p_heartbeat != NULL) && (p_resync != NULL) ){
+        *p_resync = false;
+        struct pollfd fds;
+        fds.fd      = sfd;
+        fds.events  = POLLIN;
+        fds.revents = 0;
+        if( poll(&fds,1,RESYNC_TIMEOUT) > 0 ){
+            char    reply[STAT_PACKET_MAX_SIZE];
+            ssize_t len = recv(sfd,reply,sizeof(reply),MSG_DONTWAIT);
+            if( len > 0 ) *p_resync = p_heartbeat->IsResync(reply,len);
+        }
+    }
+
     // close stream
     close(sfd);
 
@@ -26,6 +26,8 @@
 #include <StatClient.hpp>
 #include <ClientOptions.hpp>
 #include <StatDatagram.hpp>
+#include <SessionCollector.hpp>
+#include <SessionMonitor.hpp>
 
 // -----------------------------------------------------------------------------
 
@@ -46,17 +48,32 @@ public:
 
 // executive methods -----------------------------------------------------------
 
+    /// send full datagram or heartbeat if the state is unchanged
+    bool SendNodeStatus(void);
+
     /// send data to server
-    bool SendDataToServer(const CSmallString& servername,int port);
+    /*!
+      if p_heartbeat is provided, the server reply is awaited and p_resync is set
+      when the server does not know the node state
+    */
+    bool SendDataToServer(const CSmallString& servername,int port,const void* p_data,size_t size,
+                          CStatHeartbeat* p_heartbeat=NULL,bool* p_resync=NULL);
 
 // section of private data -----------------------------------------------------
 private:
     CStatClientOptions  Options;
     CStatDatagram       Datagram;
+    CSessionCollector   Sessions;
+    CSessionMonitor     Monitor;
     CTerminalStr        Console;
     CVerboseStr         vout;
     bool                Terminated;
 
+    // last state known by the server
+    bool                LastStateValid;
+    unsigned int        LastStateHash;
+    int                 LastFullUpdate;
+
     static void CtrlCSignalHandler(int signal);
 };
 
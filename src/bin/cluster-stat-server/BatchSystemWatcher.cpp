@@ -23,7 +23,11 @@
 #include <SmallTimeAndDate.hpp>
 #include <XMLElement.hpp>
 #include <PBSProServer.hpp>
+#include <Metrics.hpp>
 #include <unistd.h>
+#include <stdlib.h>
+#include <time.h>
+#include <iomanip>
 
 //------------------------------------------------------------------------------
 
@@ -36,6 +40,7 @@ using namespace std;
 CBatchSystemWatcher::CBatchSystemWatcher(void)
 {
     PoolingTime         = 20;
+    ReconnectTime       = 300;
 }
 
 //==============================================================================
@@ -72,6 +77,13 @@ bool CBatchSystemWatcher::ProcessBatchSystemControl(CVerboseStr& vout,CXMLElemen
         vout << "# PBSPro Pooling Time           = " << PoolingTime << " (default)" << endl;
     }
 
+    if( p_config->GetAttribute("ReconnectTime",ReconnectTime) == true ) {
+        vout << "# PBSPro Max Reconnect Time     = " << ReconnectTime << endl;
+    } else {
+        vout << "# PBSPro Max Reconnect Time     = " << ReconnectTime << " (default)" << endl;
+    }
+    if( ReconnectTime < 1 ) ReconnectTime = 1;
+
     PBSVersion = "PBSPro";
     if( p_config->GetAttribute("PBSVersion",PBSVersion) == true ) {
         vout << "# PBS Version                   = " << PBSVersion << endl;
@@ -100,18 +112,107 @@ bool CBatchSystemWatcher::ProcessBatchSystemControl(CVerboseStr& vout,CXMLElemen
 //------------------------------------------------------------------------------
 //==============================================================================
 
+void CBatchSystemWatcher::PrintStatistics(CVerboseStr& vout)
+{
+    unsigned long cycles = Metrics.PBSPollDuration.GetCount();
+    vout << "# Number of PBS connects               = " << Metrics.PBSConnects.Get() << endl;
+    vout << "# Number of failed PBS connects        = " << Metrics.FailedPBSConnects.Get() << endl;
+    vout << "# Number of PBS update cycles          = " << cycles << endl;
+    vout << "# Number of failed PBS update cycles   = " << Metrics.FailedPBSPolls.Get() << endl;
+    if( cycles > 0 ){
+    vout << "# Average PBS update cycle time [s]    = " << fixed << setprecision(3) << Metrics.PBSPollDuration.GetSum() / cycles << endl;
+    vout << "# Max PBS update cycle time [s]        = " << fixed << setprecision(3) << Metrics.PBSPollMaxDuration.Get() * 1.0e-6 << endl;
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
 void CBatchSystemWatcher::ExecuteThread(void)
 {
     // disable kerberos
     setenv("PBSPRO_IGNORE_KERBEROS","yes",1);
 
+    int backoff = 0;
+    int next_connect = 0;
+
     while( ! ThreadTerminated ) {
-        if( PBSPro.ConnectToServer() == true ){
-            PBSPro.UpdateNodes();
+        // the connection is kept open between cycles
+        if( Connect(backoff,next_connect) == false ){
+            Sleep(1);
+            continue;
+        }
+
+        double start = GetTime();
+        bool result = PBSPro.UpdateNodes();
+        double duration = GetTime() - start;
+        Metrics.PBSPollDuration.Observe(duration);
+        Metrics.PBSPollMaxDuration.SetMax((long)(duration*1.0e6));
+        if( result == false ) Metrics.FailedPBSPolls.Inc();
+
+        if( result == false ){
+            // the connection is likely broken - open a new one in the next cycle
             PBSPro.DisconnectFromServer();
         }
-        sleep(PoolingTime);
+
+        Sleep(PoolingTime);
+    }
+
+    PBSPro.DisconnectFromServer();
+}
+
+//------------------------------------------------------------------------------
+
+bool CBatchSystemWatcher::Connect(int& backoff,int& next_connect)
+{
+    if( PBSPro.IsConnected() == true ) return(true);
+
+    CSmallTimeAndDate time;
+    time.GetActualTimeAndDate();
+    int now = time.GetSecondsFromBeginning();
+
+    if( now < next_connect ) return(false);
+
+    bool result = PBSPro.ConnectToServer();
+
+    Metrics.PBSConnects.Inc();
+    if( result == false ) Metrics.FailedPBSConnects.Inc();
+
+    if( result == true ){
+        backoff = 0;
+        return(true);
     }
+
+    // exponential backoff with jitter - do not let all servers reconnect at once
+    backoff = backoff * 2;
+    if( backoff < 1 ) backoff = 1;
+    if( backoff > ReconnectTime ) backoff = ReconnectTime;
+
+    static unsigned int seed = getpid();
+    int delay = backoff / 2 + rand_r(&seed) % (backoff / 2 + 1);
+    if( delay < 1 ) delay = 1;
+    next_connect = now + delay;
+
+    return(false);
+}
+
+//------------------------------------------------------------------------------
+
+void CBatchSystemWatcher::Sleep(int seconds)
+{
+    for(int i=0; (i < seconds) && (! ThreadTerminated); i++){
+        sleep(1);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+double CBatchSystemWatcher::GetTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return(ts.tv_sec + ts.tv_nsec * 1.0e-9);
 }
 
 //==============================================================================
@@ -35,15 +35,28 @@ public:
     //! read common setup
     bool ProcessBatchSystemControl(CVerboseStr& vout,CXMLElement* p_config);
 
+    //! print statistics (they are kept in Metrics)
+    void PrintStatistics(CVerboseStr& vout);
+
 // section of private data -----------------------------------------------------
 private:
     CSmallString    PBSProLibNames;
     CSmallString    PBSServerName;
     int             PoolingTime;
+    int             ReconnectTime;  // max delay between reconnection attempts
     CSmallString    PBSVersion;     // PBSPro, OpenPBS
 
     // main loop
     virtual void ExecuteThread(void);
+
+    // connect if needed, false if the connection is not available
+    bool Connect(int& backoff,int& next_connect);
+
+    // sleep but wake up on termination
+    void Sleep(int seconds);
+
+    // monotonic time in seconds
+    static double GetTime(void);
 };
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,358 @@
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <CommandRunner.hpp>
+#include <ErrorSystem.hpp>
+#include <SmallString.hpp>
+#include <XMLElement.hpp>
+#include <Metrics.hpp>
+#include <spawn.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <iomanip>
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+extern char** environ;
+
+using namespace std;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CCommandRunner::CCommand::CCommand(void)
+{
+    Kind        = ECK_POWERON;
+    PID         = -1;
+    SubmitTime  = 0;
+    StartTime   = 0;
+    Killed      = false;
+}
+
+//------------------------------------------------------------------------------
+
+CCommandRunner::CCommandRunner(void)
+{
+    MaxQueue        = 64;
+    MaxRunning      = 4;
+    Timeout         = 120;
+    Nodes           = NULL;
+
+    NumOfQueued     = 0;
+    NumOfRejected   = 0;
+    NumOfFailed     = 0;
+    NumOfTimeouts   = 0;
+    MaxQueueDepth   = 0;
+    NumOfFinished   = 0;
+    TotalLatency    = 0;
+    MaxLatency      = 0;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CCommandRunner::ProcessCommandControl(CVerboseStr& vout,CXMLElement* p_config)
+{
+    vout << "#" << endl;
+    vout << "# === [commands] ===============================================================" << endl;
+
+    if( p_config == NULL ){
+        vout << "# Max queued commands (maxqueue)                 = " << setw(6) << MaxQueue << "              (default)" << endl;
+        vout << "# Max running commands (maxrunning)              = " << setw(6) << MaxRunning << "              (default)" << endl;
+        vout << "# Command timeout (timeout) [s]                  = " << setw(6) << Timeout << "              (default)" << endl;
+        return(true);
+    }
+
+    if( p_config->GetAttribute("maxqueue",MaxQueue) == true ) {
+        vout << "# Max queued commands (maxqueue)                 = " << setw(6) << MaxQueue << endl;
+    } else {
+        vout << "# Max queued commands (maxqueue)                 = " << setw(6) << MaxQueue << "              (default)" << endl;
+    }
+
+    if( p_config->GetAttribute("maxrunning",MaxRunning) == true ) {
+        vout << "# Max running commands (maxrunning)              = " << setw(6) << MaxRunning << endl;
+    } else {
+        vout << "# Max running commands (maxrunning)              = " << setw(6) << MaxRunning << "              (default)" << endl;
+    }
+
+    if( p_config->GetAttribute("timeout",Timeout) == true ) {
+        vout << "# Command timeout (timeout) [s]                  = " << setw(6) << Timeout << endl;
+    } else {
+        vout << "# Command timeout (timeout) [s]                  = " << setw(6) << Timeout << "              (default)" << endl;
+    }
+
+    if( MaxRunning == 0 ){
+        ES_ERROR("maxrunning must be greater than zero");
+        return(false);
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void CCommandRunner::SetRegistry(CNodeRegistry* p_nodes)
+{
+    Nodes = p_nodes;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CCommandRunner::Submit(ECommandKind kind,const std::string& node,const std::string& cmd)
+{
+    CCommand command;
+    command.Kind        = kind;
+    command.Node        = node;
+    command.Command     = cmd;
+    command.SubmitTime  = GetTime();
+
+    bool result = false;
+
+    QueueMutex.Lock();
+        if( Queue.size() < MaxQueue ){
+            Queue.push_back(command);
+            NumOfQueued++;
+            if( Queue.size() > MaxQueueDepth ) MaxQueueDepth = Queue.size();
+            result = true;
+        } else {
+            NumOfRejected++;
+        }
+    QueueMutex.Unlock();
+
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+void CCommandRunner::PrintStatistics(CVerboseStr& vout)
+{
+    QueueMutex.Lock();
+        vout << "# Number of queued commands            = " << NumOfQueued << endl;
+        vout << "# Number of rejected commands          = " << NumOfRejected << endl;
+        vout << "# Number of failed commands            = " << NumOfFailed << endl;
+        vout << "# Number of timed out commands         = " << NumOfTimeouts << endl;
+        vout << "# Max command queue depth              = " << MaxQueueDepth << endl;
+        if( NumOfFinished > 0 ){
+        vout << "# Average command latency [s]          = " << fixed << setprecision(3) << TotalLatency / NumOfFinished << endl;
+        vout << "# Max command latency [s]              = " << fixed << setprecision(3) << MaxLatency << endl;
+        }
+    QueueMutex.Unlock();
+}
+
+//------------------------------------------------------------------------------
+
+void CCommandRunner::PrintMetrics(std::ostream& str)
+{
+    QueueMutex.Lock();
+        unsigned int depth      = Queue.size();
+        unsigned int max_depth  = MaxQueueDepth;
+        unsigned int queued     = NumOfQueued;
+        unsigned int rejected   = NumOfRejected;
+        unsigned int failed     = NumOfFailed;
+        unsigned int timeouts   = NumOfTimeouts;
+    QueueMutex.Unlock();
+
+    str << "# HELP clusterstat_command_queue_depth Commands waiting for execution.\n";
+    str << "# TYPE clusterstat_command_queue_depth gauge\n";
+    str << "clusterstat_command_queue_depth " << depth << "\n";
+
+    str << "# HELP clusterstat_command_queue_max_depth Max number of commands waiting for execution.\n";
+    str << "# TYPE clusterstat_command_queue_max_depth gauge\n";
+    str << "clusterstat_command_queue_max_depth " << max_depth << "\n";
+
+    str << "# HELP clusterstat_commands_queued_total Accepted commands.\n";
+    str << "# TYPE clusterstat_commands_queued_total counter\n";
+    str << "clusterstat_commands_queued_total " << queued << "\n";
+
+    str << "# HELP clusterstat_commands_rejected_total Commands rejected because the queue was full.\n";
+    str << "# TYPE clusterstat_commands_rejected_total counter\n";
+    str << "clusterstat_commands_rejected_total " << rejected << "\n";
+
+    str << "# HELP clusterstat_commands_failed_total Failed commands including timeouts.\n";
+    str << "# TYPE clusterstat_commands_failed_total counter\n";
+    str << "clusterstat_commands_failed_total " << failed << "\n";
+
+    str << "# HELP clusterstat_commands_timeout_total Commands killed after the timeout.\n";
+    str << "# TYPE clusterstat_commands_timeout_total counter\n";
+    str << "clusterstat_commands_timeout_total " << timeouts << "\n";
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CCommandRunner::ExecuteThread(void)
+{
+    while( ! ThreadTerminated ) {
+        StartCommands();
+        CheckCommands();
+        usleep(100000); // sleep for 100 ms
+    }
+
+    // running commands are not killed, they are adopted by init
+    if( Running.size() > 0 ){
+        CSmallString warning;
+        warning << Running.size() << " command(s) still running at exit";
+        ES_WARNING(warning);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CCommandRunner::StartCommands(void)
+{
+    while( Running.size() < MaxRunning ){
+        CCommand cmd;
+
+        QueueMutex.Lock();
+            if( Queue.empty() ){
+                QueueMutex.Unlock();
+                return;
+            }
+            cmd = Queue.front();
+            Queue.pop_front();
+        QueueMutex.Unlock();
+
+        if( Spawn(cmd) == false ){
+            Finished(cmd,false);
+            continue;
+        }
+        Running.push_back(cmd);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CCommandRunner::CheckCommands(void)
+{
+    double now = GetTime();
+
+    std::list<CCommand>::iterator it = Running.begin();
+    while( it != Running.end() ){
+        int status = 0;
+        pid_t ret = waitpid(it->PID,&status,WNOHANG);
+
+        if( ret == 0 ){
+            // still running
+            if( (it->Killed == false) && (now - it->StartTime > Timeout) ){
+                CSmallString error;
+                error << "command '" << it->Command.c_str() << "' timed out - killing it";
+                ES_ERROR(error);
+                kill(-it->PID,SIGKILL);
+                it->Killed = true;
+            }
+            it++;
+            continue;
+        }
+
+        bool success = (ret == it->PID) && (it->Killed == false) && WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+        if( (success == false) && (it->Killed == false) ){
+            CSmallString error;
+            error << "unable to execute command '" << it->Command.c_str() << "'";
+            ES_ERROR(error);
+        }
+        if( it->Killed ){
+            QueueMutex.Lock();
+                NumOfTimeouts++;
+            QueueMutex.Unlock();
+        }
+
+        Finished(*it,success);
+        it = Running.erase(it);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+bool CCommandRunner::Spawn(CCommand& cmd)
+{
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    // own process group - the whole group is killed on timeout
+    posix_spawnattr_setpgroup(&attr,0);
+    posix_spawnattr_setflags(&attr,POSIX_SPAWN_SETPGROUP);
+
+    const char* argv[] = {"/bin/sh", "-c", cmd.Command.c_str(), NULL};
+
+    pid_t pid;
+    int ret = posix_spawn(&pid,"/bin/sh",NULL,&attr,const_cast<char* const*>(argv),environ);
+    posix_spawnattr_destroy(&attr);
+
+    if( ret != 0 ){
+        CSmallString error;
+        error << "unable to spawn command '" << cmd.Command.c_str() << "'";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    cmd.PID         = pid;
+    cmd.StartTime   = GetTime();
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void CCommandRunner::Finished(const CCommand& cmd,bool success)
+{
+    double now = GetTime();
+    double latency = now - cmd.SubmitTime;
+
+    // runtime of spawned commands only
+    if( cmd.StartTime > 0 ) Metrics.CommandDuration.Observe(now - cmd.StartTime);
+
+    QueueMutex.Lock();
+        NumOfFinished++;
+        TotalLatency += latency;
+        if( latency > MaxLatency ) MaxLatency = latency;
+        if( success == false ) NumOfFailed++;
+    QueueMutex.Unlock();
+
+    if( (success == true) || (Nodes == NULL) ) return;
+
+    // unable to run - do not mark the node
+    switch(cmd.Kind){
+        case ECK_POWERON:
+            Nodes->SetPowerOnMode(cmd.Node,false,0);
+            break;
+        case ECK_STARTVNC:
+            Nodes->SetStartVNCMode(cmd.Node,false,0);
+            break;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+double CCommandRunner::GetTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return(ts.tv_sec + ts.tv_nsec * 1.0e-9);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
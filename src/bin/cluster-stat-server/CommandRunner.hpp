@@ -0,0 +1,132 @@
+#ifndef CommandRunnerH
+#define CommandRunnerH
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SmartThread.hpp>
+#include <SimpleMutex.hpp>
+#include <VerboseStr.hpp>
+#include <NodeRegistry.hpp>
+#include <sys/types.h>
+#include <list>
+#include <string>
+#include <ostream>
+
+//------------------------------------------------------------------------------
+
+class CXMLElement;
+
+//------------------------------------------------------------------------------
+
+enum ECommandKind {
+    ECK_POWERON     = 1,    // node power on
+    ECK_STARTVNC    = 2,    // start of remote desktop
+};
+
+//------------------------------------------------------------------------------
+
+//! asynchronous execution of node commands
+/*! \ingroup eserver
+
+  [commands]
+  maxqueue          (int)    - max number of commands waiting for execution
+  maxrunning        (int)    - max number of concurrently running commands
+  timeout           (int)    - time in seconds after which the command is killed
+
+  commands are executed by /bin/sh in their own process group, the node mode
+  (power on or start VNC) is cleared when the command fails or times out
+*/
+class CCommandRunner : public CSmartThread {
+public:
+// constructor -----------------------------------------------------------------
+    CCommandRunner(void);
+
+    //! read runner setup
+    bool ProcessCommandControl(CVerboseStr& vout,CXMLElement* p_config);
+
+    //! set registry with node modes
+    void SetRegistry(CNodeRegistry* p_nodes);
+
+// executive methods -----------------------------------------------------------
+    //! queue command, false if the queue is full
+    bool Submit(ECommandKind kind,const std::string& node,const std::string& cmd);
+
+    //! print statistics
+    void PrintStatistics(CVerboseStr& vout);
+
+    //! print queue metrics in Prometheus text format
+    void PrintMetrics(std::ostream& str);
+
+// section of private data -----------------------------------------------------
+private:
+    class CCommand {
+    public:
+        CCommand(void);
+    public:
+        ECommandKind    Kind;
+        std::string     Node;
+        std::string     Command;
+        pid_t           PID;
+        double          SubmitTime;     // monotonic time in seconds
+        double          StartTime;
+        bool            Killed;
+    };
+
+    unsigned int            MaxQueue;
+    unsigned int            MaxRunning;
+    int                     Timeout;    // in seconds
+    CNodeRegistry*          Nodes;
+
+    CSimpleMutex            QueueMutex;
+    std::list<CCommand>     Queue;
+    std::list<CCommand>     Running;    // accessed only by the runner thread
+
+    // statistics - protected by QueueMutex
+    unsigned int            NumOfQueued;
+    unsigned int            NumOfRejected;
+    unsigned int            NumOfFailed;
+    unsigned int            NumOfTimeouts;
+    unsigned int            MaxQueueDepth;
+    unsigned int            NumOfFinished;
+    double                  TotalLatency;   // from submission to finish
+    double                  MaxLatency;
+
+    // main loop
+    virtual void ExecuteThread(void);
+
+    // start queued commands
+    void StartCommands(void);
+
+    // reap finished commands and kill those running too long
+    void CheckCommands(void);
+
+    // spawn command, false on error
+    bool Spawn(CCommand& cmd);
+
+    // command finished
+    void Finished(const CCommand& cmd,bool success);
+
+    // monotonic time in seconds
+    static double GetTime(void);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
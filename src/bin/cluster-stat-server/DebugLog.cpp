@@ -0,0 +1,211 @@
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <DebugLog.hpp>
+#include <ErrorSystem.hpp>
+#include <SmallTimeAndDate.hpp>
+#include <XMLElement.hpp>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <string.h>
+#include <iomanip>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+// max number of messages waiting for the log thread
+#define MAX_QUEUE_SIZE  10000
+
+//------------------------------------------------------------------------------
+
+CDebugLog DebugLog;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CDebugLog::CDebugLog(void)
+{
+    Enabled         = false;
+    LogFile         = "/var/lib/cluster-stat/cluster-stat-server-debug.log";
+    MaxRate         = 100;
+    RateTime        = 0;
+    RateCount       = 0;
+    NumOfDropped    = 0;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CDebugLog::ProcessDebugLogControl(CVerboseStr& vout,CXMLElement* p_config)
+{
+    vout << "#" << endl;
+    vout << "# === [debuglog] ===============================================================" << endl;
+
+    if( p_config == NULL ){
+        vout << "# Debug log (enabled)                            = " << setw(6) << bool_to_str(Enabled) << "              (default)" << endl;
+        vout << "# Log file (file)                                = " << LogFile << " (default)" << endl;
+        vout << "# Max messages per second (maxrate)              = " << setw(6) << MaxRate << "              (default)" << endl;
+        return(true);
+    }
+
+    bool enabled = Enabled;
+    if( p_config->GetAttribute("enabled",enabled) == true ) {
+        Enabled = enabled;
+        vout << "# Debug log (enabled)                            = " << setw(6) << bool_to_str(Enabled) << endl;
+    } else {
+        vout << "# Debug log (enabled)                            = " << setw(6) << bool_to_str(Enabled) << "              (default)" << endl;
+    }
+
+    if( p_config->GetAttribute("file",LogFile) == true ) {
+        vout << "# Log file (file)                                = " << LogFile << endl;
+    } else {
+        vout << "# Log file (file)                                = " << LogFile << " (default)" << endl;
+    }
+
+    if( p_config->GetAttribute("maxrate",MaxRate) == true ) {
+        vout << "# Max messages per second (maxrate)              = " << setw(6) << MaxRate << endl;
+    } else {
+        vout << "# Max messages per second (maxrate)              = " << setw(6) << MaxRate << "              (default)" << endl;
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CDebugLog::IsEnabled(void)
+{
+    return(Enabled);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CDebugLog::Write(const std::string& msg)
+{
+    if( Enabled == false ) return;
+
+    CSmallTimeAndDate time;
+    time.GetActualTimeAndDate();
+    int now = time.GetSecondsFromBeginning();
+
+    QueueMutex.Lock();
+        if( RateTime != now ){
+            RateTime = now;
+            RateCount = 0;
+        }
+        if( (RateCount < MaxRate) && (Queue.size() < MAX_QUEUE_SIZE) ){
+            Queue.push_back(msg);
+            RateCount++;
+        } else {
+            NumOfDropped++;
+        }
+    QueueMutex.Unlock();
+}
+
+//------------------------------------------------------------------------------
+
+unsigned int CDebugLog::GetNumOfDropped(void)
+{
+    QueueMutex.Lock();
+        unsigned int dropped = NumOfDropped;
+    QueueMutex.Unlock();
+    return(dropped);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CDebugLog::ExecuteThread(void)
+{
+    if( Enabled == false ) return;
+
+    // do not follow links planted by other users
+    FILE* p_fout = NULL;
+    int fd = open(LogFile,O_WRONLY|O_APPEND|O_CREAT|O_NOFOLLOW,0600);
+    if( fd >= 0 ){
+        struct stat info;
+        if( (fstat(fd,&info) == 0) && S_ISREG(info.st_mode) && (info.st_uid == geteuid()) ){
+            p_fout = fdopen(fd,"a");
+        } else {
+            errno = EPERM;
+        }
+        if( p_fout == NULL ) close(fd);
+    }
+
+    if( p_fout == NULL ){
+        CSmallString error;
+        error << "unable to open debug log '" << LogFile << "' (" << strerror(errno) << ")";
+        ES_ERROR(error);
+        Enabled = false;
+        // discard messages queued before the log was disabled
+        QueueMutex.Lock();
+            Queue.clear();
+        QueueMutex.Unlock();
+        return;
+    }
+
+    while( ! ThreadTerminated ) {
+        Flush(p_fout);
+        usleep(500000); // sleep for 500 ms
+    }
+
+    Flush(p_fout);
+    fclose(p_fout);
+}
+
+//------------------------------------------------------------------------------
+
+void CDebugLog::Flush(FILE* p_fout)
+{
+    std::list<std::string> messages;
+
+    QueueMutex.Lock();
+        messages.swap(Queue);
+    QueueMutex.Unlock();
+
+    if( messages.empty() ) return;
+
+    std::list<std::string>::iterator it = messages.begin();
+    std::list<std::string>::iterator ie = messages.end();
+
+    while( it != ie ){
+        fputs(it->c_str(),p_fout);
+        fputc('\n',p_fout);
+        it++;
+    }
+
+    // one flush per batch
+    fflush(p_fout);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,92 @@
+#ifndef DebugLogH
+#define DebugLogH
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SmartThread.hpp>
+#include <SimpleMutex.hpp>
+#include <SmallString.hpp>
+#include <VerboseStr.hpp>
+#include <FileName.hpp>
+#include <list>
+#include <string>
+#include <boost/atomic.hpp>
+
+//------------------------------------------------------------------------------
+
+class CXMLElement;
+
+//------------------------------------------------------------------------------
+
+//! asynchronous debug log
+/*! \ingroup eserver
+
+  [debuglog]
+  enabled           (on/off) - determine if debug messages are written
+  file              (path)   - log file, it must be a regular file owned by the server
+  maxrate           (int)    - max number of messages per second, others are dropped
+
+  messages are only queued, they are written by the log thread
+  the log is opened in append mode and it is neither rotated nor size limited
+*/
+class CDebugLog : public CSmartThread {
+public:
+// constructor -----------------------------------------------------------------
+    CDebugLog(void);
+
+    //! read log setup
+    bool ProcessDebugLogControl(CVerboseStr& vout,CXMLElement* p_config);
+
+    //! is the log enabled?
+    bool IsEnabled(void);
+
+// executive methods -----------------------------------------------------------
+    //! queue message
+    void Write(const std::string& msg);
+
+    //! number of dropped messages
+    unsigned int GetNumOfDropped(void);
+
+// section of private data -----------------------------------------------------
+private:
+    boost::atomic<bool>     Enabled;        // cleared by the log thread if the log cannot be opened
+    CFileName               LogFile;
+    int                     MaxRate;
+
+    CSimpleMutex            QueueMutex;
+    std::list<std::string>  Queue;
+    int                     RateTime;       // second of the current rate window
+    int                     RateCount;      // messages in the current window
+    unsigned int            NumOfDropped;
+
+    // main loop
+    virtual void ExecuteThread(void);
+
+    // write queued messages
+    void Flush(FILE* p_fout);
+};
+
+//------------------------------------------------------------------------------
+
+extern CDebugLog DebugLog;
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -34,8 +34,12 @@
 #include <XMLPrinter.hpp>
 #include <XMLText.hpp>
 #include <iostream>
+#include <sstream>
 #include <pbs_ifl.h>
 #include <PBSProAttr.hpp>
+#include <HostResolver.hpp>
+#include <DebugLog.hpp>
+#include <Metrics.hpp>
 
 //------------------------------------------------------------------------------
 
@@ -53,43 +57,14 @@ MAIN_ENTRY_OBJECT(ClusterStatServer)
 //------------------------------------------------------------------------------
 //==============================================================================
 
-CCompNode::CCompNode(void)
-{
-    InPowerOnMode = false;
-    PowerOnTime = 0;
-
-    InStartVNCMode = false;
-    StartVNCTime = 0;
-
-    PowerStat = EPS_UNKNOWN;
-    NGPUs = 0;
-
-    Basic.Clear();
-}
-
-//------------------------------------------------------------------------------
-
-void CCompNode::Clear(void)
-{
-    InPowerOnMode = false;
-    PowerOnTime = 0;
-
-    InStartVNCMode = false;
-    StartVNCTime = 0;
-
-    CSmallString node = Basic.GetNodeName();
-    Basic.Clear();
-    Basic.SetNodeName(node);
-}
-
-//==============================================================================
-//------------------------------------------------------------------------------
-//==============================================================================
-
 CFCGIStatServer::CFCGIStatServer(void)
 {
     FCGIPort        = 32597;
     StatPort        = 32598;
+    StatRcvBuf      = 4*1024*1024;
+    StatBatch       = 32;
+    StatReceivers   = 4;
+    FCGIWorkers     = 4;
     MaxNodes        = 100;
     RDSKPath        = "/var/lib/websockify";
     DomainName      = "ncbr.muni.cz";
@@ -145,35 +120,105 @@ bool CFCGIStatServer::Run(void)
     signal(SIGTERM,CtrlCSignalHandler);
 
     SetPort(FCGIPort);
-    StatServer.SetPort(StatPort);
+
+    for(int i=0; i < StatReceivers; i++){
+        CStatServerPtr receiver(new CStatServer);
+        receiver->SetPort(StatPort);
+        receiver->SetReceiveBuffer(StatRcvBuf);
+        receiver->SetBatchSize(StatBatch);
+        receiver->SetReusePort(StatReceivers > 1);
+        StatServers.push_back(receiver);
+    }
+
+    // restore nodes before any datagram is received
+    StateStore.SetRegistry(&Nodes);
+    StateStore.Load(vout);
 
     // start servers
     Watcher.StartThread();          // watcher
+    HostResolver.StartThread();     // reverse DNS lookups
+    DebugLog.StartThread();         // debug messages
+    Notifier.SetRegistry(&Nodes);
+    Notifier.StartThread();         // seat change streams
+    Commands.SetRegistry(&Nodes);
+    Commands.StartThread();         // node commands
     BatchSystem.StartThread();      // batch system
-    StatServer.StartThread();       // stat server
+    StateStore.StartThread();       // node state checkpoints
+    for(size_t i=0; i < StatServers.size(); i++){
+        StatServers[i]->StartThread();  // stat server
+    }
     if( StartServer() == false ) {  // fcgi server
         return(false);
     }
+    // the server itself is the first worker
+    for(int i=1; i < FCGIWorkers; i++){
+        CFCGIWorkerPtr worker(new CFCGIWorker(this));
+        worker->StartThread();      // fcgi worker
+        Workers.push_back(worker);
+    }
 
     vout << low;
     vout << "Waiting for server terminations ..." << endl;
     WaitForServer();
 
+    vout << "Waiting for FCGI worker termination ..." << endl;
+    for(size_t i=0; i < Workers.size(); i++){
+        Workers[i]->TerminateThread();
+    }
+    for(size_t i=0; i < Workers.size(); i++){
+        Workers[i]->WaitForThread();
+    }
+
     vout << "Waiting for STAT server termination ..." << endl;
-    StatServer.TerminateServer();
-    StatServer.WaitForThread();
+    for(size_t i=0; i < StatServers.size(); i++){
+        StatServers[i]->TerminateServer();
+        StatServers[i]->WaitForThread();
+    }
+
+    vout << "Waiting for state store termination ..." << endl;
+    StateStore.TerminateThread();
+    StateStore.WaitForThread();
 
     vout << "Waiting for watcher server termination ..." << endl;
     Watcher.TerminateThread();
     Watcher.WaitForThread();
 
+    vout << "Waiting for command runner termination ..." << endl;
+    Commands.TerminateThread();
+    Commands.WaitForThread();
+
+    vout << "Waiting for notifier termination ..." << endl;
+    Notifier.TerminateThread();
+    Notifier.WaitForThread();
+
+    vout << "Waiting for resolver termination ..." << endl;
+    HostResolver.TerminateThread();
+    HostResolver.WaitForThread();
+
     vout << "Waiting for batch system server termination ..." << endl;
     BatchSystem.TerminateThread();
     BatchSystem.WaitForThread();
 
-    vout << "# Number of client total requests      = " << StatServer.AllRequests << endl;
-    vout << "# Number of client successful requests = " << StatServer.SuccessfulRequests << endl;
-    vout << "# Number of nodes                      = " << Nodes.size() << endl;
+    vout << "Waiting for debug log termination ..." << endl;
+    DebugLog.TerminateThread();
+    DebugLog.WaitForThread();
+
+    vout << "# Number of client total requests      = " << Metrics.Datagrams.Get() << endl;
+    vout << "# Number of client successful requests = " << Metrics.AcceptedDatagrams.Get() << endl;
+    vout << "# Number of client heartbeats          = " << Metrics.Heartbeats.Get() << endl;
+    vout << "# Number of resync requests            = " << Metrics.ResyncRequests.Get() << endl;
+    vout << "# Number of legacy (v3) datagrams      = " << Metrics.LegacyDatagrams.Get() << endl;
+    vout << "# Number of receive batches            = " << Metrics.ReceiveBatches.Get() << endl;
+    vout << "# Number of kernel-dropped datagrams   = " << GetNumOfKernelDrops() << endl;
+    vout << "# Number of nodes                      = " << Nodes.GetNumOfNodes() << endl;
+    vout << "# Number of response cache hits        = " << ResponseCache.GetHits() << endl;
+    vout << "# Number of response cache misses      = " << ResponseCache.GetMisses() << endl;
+    vout << "# Number of rejected watch subscribers = " << Notifier.GetNumOfRejected() << endl;
+    vout << "# Number of dropped watch subscribers  = " << Notifier.GetNumOfDropped() << endl;
+    Commands.PrintStatistics(vout);
+    BatchSystem.PrintStatistics(vout);
+    StateStore.PrintStatistics(vout);
+    vout << "# Number of dropped debug messages     = " << DebugLog.GetNumOfDropped() << endl;
     vout << endl;
 
     return(true);
@@ -203,40 +248,27 @@ void CFCGIStatServer::Finalize(void)
 
 //------------------------------------------------------------------------------
 
-void CFCGIStatServer::RegisterNode(CStatDatagram& dtg)
+bool CFCGIStatServer::RegisterNode(CStatDatagram& dtg)
 {
-    NodesMutex.Lock();
-
-    string node = string(dtg.GetNodeName());
-
-    if( MaxNodes == Nodes.size() ){
-        // too many nodes and the node is not registered yet
-        if( Nodes.count(node) != 1 ){
-            NodesMutex.Unlock();
-            ES_ERROR("too many nodes - skiping new registration");
-            return;
-        }
-    }
+    return(Nodes.RegisterNode(dtg));
+}
 
-    if( Nodes.count(node) == 1 ) {
-        // the node is registered
-        Nodes[node]->Basic = dtg;
+//------------------------------------------------------------------------------
 
-        // clear power on status
-        Nodes[node]->InPowerOnMode  = false;
-        Nodes[node]->PowerOnTime    = 0;
+bool CFCGIStatServer::RefreshNode(CStatHeartbeat& hb)
+{
+    return(Nodes.RefreshNode(hb));
+}
 
-    } else {
-        // new registration
-        CCompNodePtr data(new CCompNode);
-        data->Basic          = dtg;
-        data->InPowerOnMode  = false;
-        data->PowerOnTime    = 0;
+//------------------------------------------------------------------------------
 
-        Nodes[node] = data;
+long CFCGIStatServer::GetNumOfKernelDrops(void)
+{
+    long kernel_drops = 0;
+    for(size_t i=0; i < StatServers.size(); i++){
+        kernel_drops += StatServers[i]->KernelDrops.Get();
     }
-
-    NodesMutex.Unlock();
+    return(kernel_drops);
 }
 
 //==============================================================================
@@ -247,10 +279,16 @@ bool CFCGIStatServer::AcceptRequest(void)
 {
     // this is simple FCGI Application with 'Hello world!'
 
-    CFCGIRequest request;
+    // the request can be taken over by the notifier
+    CFCGIRequestPtr p_request(new CFCGIRequest);
+    CFCGIRequest&   request = *p_request;
+
+    // accept request - only one thread can wait in accept
+    AcceptMutex.Lock();
+    bool accepted = request.AcceptRequest(this);
+    AcceptMutex.Unlock();
 
-    // accept request
-    if( request.AcceptRequest(this) == false ) {
+    if( accepted == false ) {
         ES_ERROR("unable to accept request");
         // unable to accept request
         return(false);
@@ -258,14 +296,15 @@ bool CFCGIStatServer::AcceptRequest(void)
 
     request.Params.LoadParamsFromQuery();
 
-    // write document
-    request.OutStream.PutStr("Content-type: text/html\r\n");
-    request.OutStream.PutStr("\r\n");
+    // headers are written by SendResponse() or _Error()
 
     // get request id
     CSmallString action;
     action = request.Params.GetValue("action");
 
+    EMetricAction   metric_action = CMetrics::GetAction(action);
+    double          start_time = CMetrics::GetTime();
+
     bool result = false;
 
     // user stat
@@ -281,6 +320,14 @@ bool CFCGIStatServer::AcceptRequest(void)
     if( action == "debug" ) {
         result = _Debug(request);
     }
+    if( action == "watch" ) {
+        result = _Watch(p_request);
+    }
+    if( action == "metrics" ) {
+        result = _Metrics(request);
+    }
+
+    if( result == false ) Metrics.FailedRequests[metric_action].Inc();
 
     // error handle -----------------------
     if( result == false ) {
@@ -289,6 +336,43 @@ bool CFCGIStatServer::AcceptRequest(void)
     }
     if( result == false ) request.FinishRequest(); // at least try to finish request
 
+    Metrics.Requests[metric_action].Inc();
+    Metrics.RequestDuration[metric_action].Observe(CMetrics::GetTime() - start_time);
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CFCGIStatServer::SendResponse(CFCGIRequest& request,const CResponseBody& body,const char* p_type)
+{
+    // does the client already have the same body?
+    CSmallString inm = request.Params.GetValue("HTTP_IF_NONE_MATCH");
+    bool match = false;
+    if( inm != NULL ){
+        string tags = string(inm);
+        // list of tags, possibly weak (W/"tag") or any (*)
+        if( (tags == "*") || (tags.find(body.ETag) != string::npos) ){
+            match = true;
+        }
+    }
+
+    if( match ){
+        request.OutStream.PutStr("Status: 304 Not Modified\r\n");
+        request.OutStream.PutStr("ETag: " + body.ETag + "\r\n");
+        request.OutStream.PutStr("Cache-Control: private, no-cache\r\n");
+        request.OutStream.PutStr("\r\n");
+    } else {
+        request.OutStream.PutStr("Content-type: " + string(p_type) + "\r\n");
+        request.OutStream.PutStr("ETag: " + body.ETag + "\r\n");
+        request.OutStream.PutStr("Cache-Control: private, no-cache\r\n");
+        request.OutStream.PutStr("\r\n");
+        request.OutStream.PutStr(body.Data);
+    }
+
+    // finalize request
+    request.FinishRequest();
+
     return(true);
 }
 
@@ -358,6 +442,10 @@ bool CFCGIStatServer::LoadConfig(void)
         // optional setup
         p_ele->GetAttribute("fcgiport",FCGIPort);
         p_ele->GetAttribute("statport",StatPort);
+        p_ele->GetAttribute("rcvbuf",StatRcvBuf);
+        p_ele->GetAttribute("rcvbatch",StatBatch);
+        p_ele->GetAttribute("receivers",StatReceivers);
+        p_ele->GetAttribute("fcgiworkers",FCGIWorkers);
         p_ele->GetAttribute("maxnodes",MaxNodes);
         p_ele->GetAttribute("rdskpath",RDSKPath);
         p_ele->GetAttribute("domain",DomainName);
@@ -371,7 +459,14 @@ bool CFCGIStatServer::LoadConfig(void)
     vout << "# === [servers] ================================================================" << endl;
     vout << "# FCGI Port (fcgiport)     = " << FCGIPort << endl;
     vout << "# Stat Port (statport)     = " << StatPort << endl;
+    vout << "# Rcv Buffer (rcvbuf)      = " << StatRcvBuf << endl;
+    vout << "# Rcv Batch (rcvbatch)     = " << StatBatch << endl;
+    if( StatReceivers < 1 ) StatReceivers = 1;
+    vout << "# Receivers (receivers)    = " << StatReceivers << endl;
+    if( FCGIWorkers < 1 ) FCGIWorkers = 1;
+    vout << "# Workers (fcgiworkers)    = " << FCGIWorkers << endl;
     vout << "# Max nodes (maxnodes)     = " << MaxNodes << endl;
+    Nodes.SetMaxNodes(MaxNodes);
     vout << "# RDSK Path (rdskpath)     = " << RDSKPath << endl;
     vout << "# Domain name (domain)     = " << DomainName << endl;
     vout << "# URL Template (url)       = " << URLTmp << endl;
@@ -388,9 +483,7 @@ bool CFCGIStatServer::LoadConfig(void)
             CSmallString name;
             if( p_node->GetAttribute("name",name) == true ){
                 vout << "  * " << name << endl;
-                CCompNodePtr node(new CCompNode);
-                node->Basic.SetNodeName(name);
-                Nodes[string(name)]=node;
+                Nodes.AddNode(string(name));
             }
             p_node = p_node->GetNextSiblingElement("node");
         }
@@ -399,6 +492,21 @@ bool CFCGIStatServer::LoadConfig(void)
     CXMLElement* p_watcher = ServerConfig.GetChildElementByPath("config/watcher");
     if( Watcher.ProcessWatcherControl(vout,p_watcher) == false ) return(false);
 
+    CXMLElement* p_resolver = ServerConfig.GetChildElementByPath("config/resolver");
+    if( HostResolver.ProcessResolverControl(vout,p_resolver) == false ) return(false);
+
+    CXMLElement* p_watch = ServerConfig.GetChildElementByPath("config/watch");
+    if( Notifier.ProcessWatchControl(vout,p_watch) == false ) return(false);
+
+    CXMLElement* p_commands = ServerConfig.GetChildElementByPath("config/commands");
+    if( Commands.ProcessCommandControl(vout,p_commands) == false ) return(false);
+
+    CXMLElement* p_state = ServerConfig.GetChildElementByPath("config/state");
+    if( StateStore.ProcessStateControl(vout,p_state) == false ) return(false);
+
+    CXMLElement* p_debuglog = ServerConfig.GetChildElementByPath("config/debuglog");
+    if( DebugLog.ProcessDebugLogControl(vout,p_debuglog) == false ) return(false);
+
     CXMLElement* p_batchsys = ServerConfig.GetChildElementByPath("config/batch_system");
      if( BatchSystem.ProcessBatchSystemControl(vout,p_batchsys) == false ) return(false);
     return(true);
@@ -408,35 +516,43 @@ bool CFCGIStatServer::LoadConfig(void)
 
 void CFCGIStatServer::UpdateNodePowerStatus(struct batch_status* p_node_attrs)
 {
-    NodesMutex.Lock();
-
-    ofstream ofs("/tmp/node-stat-server-pbs.log");
+    // parse PBS data without any lock
+    std::vector<CBatchNodeInfo> infos;
 
     while( p_node_attrs != NULL ){
         string node_name = string(p_node_attrs->name);
         // get short name
         node_name = node_name.substr(0,node_name.find("."));
-        ofs << "node: " << node_name <<  endl;
-        if( Nodes.count(node_name) == 1 ){
-            CCompNodePtr node = Nodes[node_name];
-            get_attribute(p_node_attrs->attribs,"resources_available","ncpus",node->NCPUs);
-            get_attribute(p_node_attrs->attribs,"resources_available","ngpus",node->NGPUs);
-            CSmallString ps;
-            get_attribute(p_node_attrs->attribs,"resources_available","power_status",ps);
-            EPowerStat status = EPS_UNKNOWN;
-            if( ps == "maintenance" ) status = EPS_MAINTANANCE;
-            if( ps == "up" ) status = EPS_UP;
-            if( ps == "down" ) status = EPS_DOWN;
-            ofs << "node: " << node_name << " st:" << status <<" (" << ps <<")" << endl;
-            node->PowerStat = status;
+
+        CBatchNodeInfo info;
+        info.Name = node_name;
+
+        // attributes can be missing as only selected resources are requested,
+        // such nodes keep their resources but the power state is reset to unknown
+        CSmallString ps;
+        if( p_node_attrs->attribs != NULL ){
+            // index attributes once for all lookups
+            CPBSProAttrIndex attrs(p_node_attrs->attribs);
+            get_attribute(attrs,"resources_available","ncpus",info.NCPUs);
+            get_attribute(attrs,"resources_available","ngpus",info.NGPUs);
+            get_attribute(attrs,"resources_available","power_status",ps);
+            if( ps == "maintenance" ) info.PowerStat = EPS_MAINTANANCE;
+            if( ps == "up" ) info.PowerStat = EPS_UP;
+            if( ps == "down" ) info.PowerStat = EPS_DOWN;
+        }
+        infos.push_back(info);
+
+        if( DebugLog.IsEnabled() ){
+            stringstream str;
+            str << "node: " << node_name << " st:" << info.PowerStat << " (" << ps << ")";
+            DebugLog.Write(str.str());
         }
 
         p_node_attrs = p_node_attrs->next;
     }
 
-    ofs.close();
-
-    NodesMutex.Unlock();
+    // merge - unknown nodes are ignored
+    Nodes.SetBatchInfo(infos);
 }
 
 //==============================================================================
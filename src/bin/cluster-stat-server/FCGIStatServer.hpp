@@ -36,39 +36,18 @@
 #include <StatServer.hpp>
 #include <SmallTimeAndDate.hpp>
 #include <map>
+#include <vector>
 #include <string>
 #include <boost/shared_ptr.hpp>
 #include <BatchSystemWatcher.hpp>
-
-//------------------------------------------------------------------------------
-
-enum EPowerStat {
-    EPS_DOWN,
-    EPS_UP,
-    EPS_MAINTANANCE,
-    EPS_UNKNOWN,
-};
-
-//------------------------------------------------------------------------------
-
-class CCompNode {
-public:
-    CCompNode(void);
-    void Clear(void);
-public:
-    CStatDatagram   Basic;
-    bool            InPowerOnMode;
-    int             PowerOnTime;
-
-    bool            InStartVNCMode;
-    int             StartVNCTime;
-
-    EPowerStat      PowerStat;
-    int             NCPUs;
-    int             NGPUs;
-};
-
-typedef boost::shared_ptr<CCompNode>   CCompNodePtr;
+#include <NodeRegistry.hpp>
+#include <ResponseCache.hpp>
+#include <SeatNotifier.hpp>
+#include <SocketIndex.hpp>
+#include <UserStateCache.hpp>
+#include <CommandRunner.hpp>
+#include <NodeStateStore.hpp>
+#include <FCGIWorker.hpp>
 
 //------------------------------------------------------------------------------
 
@@ -86,8 +65,14 @@ public:
     /// finalize
     void Finalize(void);
 
-    /// register node
-    void RegisterNode(CStatDatagram& dtg);
+    /// register node, false if there are too many nodes
+    bool RegisterNode(CStatDatagram& dtg);
+
+    /// refresh timestamp of registered node, false if the node state is not known
+    bool RefreshNode(CStatHeartbeat& hb);
+
+    /// datagrams dropped by kernel on all stat sockets
+    long GetNumOfKernelDrops(void);
 
 
     /// update node power status
@@ -101,10 +86,18 @@ private:
     CVerboseStr         vout;
     CServerWatcher      Watcher;
     CBatchSystemWatcher BatchSystem;
-    CStatServer         StatServer;
-    CSimpleMutex        NodesMutex;
+    CSeatNotifier       Notifier;
+    CCommandRunner      Commands;
+    CNodeStateStore     StateStore;
+    std::vector<CStatServerPtr> StatServers;
+    std::vector<CFCGIWorkerPtr> Workers;
+    CSimpleMutex        AcceptMutex;
     int                 FCGIPort;
     int                 StatPort;
+    int                 StatRcvBuf;
+    int                 StatBatch;
+    int                 StatReceivers;
+    int                 FCGIWorkers;
     unsigned int        MaxNodes;
     CFileName           RDSKPath;
     CFileName           DomainName;
@@ -113,11 +106,16 @@ private:
     CSmallString        StartRDSKCMD;
     CSmallString        QuotaFlag;
 
-    std::map<std::string,CCompNodePtr> Nodes;
+    CNodeRegistry       Nodes;
+    CResponseCache      ResponseCache;
+    CSocketIndex        SocketIndex;
+    CUserStateCache     UserStates;
 
     static  void CtrlCSignalHandler(int signal);
     virtual bool AcceptRequest(void);
 
+    friend class CFCGIWorker;
+
     // web pages handlers ------------------------------------------------------
     bool _Error(CFCGIRequest& request);
     bool _ListLoggedUsers(CFCGIRequest& request);
@@ -127,11 +125,18 @@ private:
     bool _RemoteAccessStartVNC(CFCGIRequest& request,const CSmallString& node);
     bool _RemoteAccessList(CFCGIRequest& request);
     bool _Debug(CFCGIRequest& request);
+    bool _Watch(CFCGIRequestPtr& p_request);
+    bool _Metrics(CFCGIRequest& request);
+
+    //! send body with its entity tag or 304 if the client tag matches
+    bool SendResponse(CFCGIRequest& request,const CResponseBody& body,const char* p_type="text/html");
 
     bool ProcessCommonParams(CFCGIRequest& request,
                              CTemplateParams& template_params);
 
     bool HasKerberos(CFCGIRequest& request);
+    bool IsQuotaExceeded(const CSmallString& ruser);
+    void GetUserState(CFCGIRequest& request,const CSmallString& ruser,CUserState& state);
     bool IsSocketLive(const CSmallString& socket);
     bool CanPowerUp(const CSmallString& node);
     bool CanStartRDSK(const CSmallString& node);
@@ -0,0 +1,50 @@
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <FCGIWorker.hpp>
+#include <FCGIStatServer.hpp>
+#include <unistd.h>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CFCGIWorker::CFCGIWorker(CFCGIStatServer* p_server)
+{
+    Server = p_server;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CFCGIWorker::ExecuteThread(void)
+{
+    while( ! ThreadTerminated ) {
+        if( Server->AcceptRequest() == false ){
+            // the listening socket is closed during server termination
+            usleep(100000); // sleep for 100 ms
+        }
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,55 @@
+#ifndef FCGIWorkerH
+#define FCGIWorkerH
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SmartThread.hpp>
+#include <boost/shared_ptr.hpp>
+
+//------------------------------------------------------------------------------
+
+class CFCGIStatServer;
+
+//------------------------------------------------------------------------------
+
+//! additional thread accepting and serving FastCGI requests
+/*!
+  accepting is serialized by the server, requests are then served concurrently
+*/
+class CFCGIWorker : public CSmartThread {
+public:
+// constructor -----------------------------------------------------------------
+    CFCGIWorker(CFCGIStatServer* p_server);
+
+// section of private data -----------------------------------------------------
+private:
+    CFCGIStatServer*    Server;
+
+    // main loop
+    virtual void ExecuteThread(void);
+};
+
+//------------------------------------------------------------------------------
+
+typedef boost::shared_ptr<CFCGIWorker>  CFCGIWorkerPtr;
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,270 @@
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <HostResolver.hpp>
+#include <ErrorSystem.hpp>
+#include <SmallTimeAndDate.hpp>
+#include <XMLElement.hpp>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <string.h>
+#include <iomanip>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+// max number of cached addresses (UDP source addresses can be spoofed)
+#define MAX_CACHE_SIZE  4096
+
+//------------------------------------------------------------------------------
+
+CHostResolver HostResolver;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CHostResolver::CHostName::CHostName(void)
+{
+    Expiration = 0;
+    Pending = false;
+}
+
+//------------------------------------------------------------------------------
+
+CHostResolver::CHostResolver(void)
+{
+    Enabled     = false;
+    CacheTTL    = 3600;
+    MaxPending  = 1024;
+
+    pthread_mutex_init(&CacheMutex,NULL);
+    pthread_cond_init(&QueueCond,NULL);
+}
+
+//------------------------------------------------------------------------------
+
+CHostResolver::~CHostResolver(void)
+{
+    pthread_cond_destroy(&QueueCond);
+    pthread_mutex_destroy(&CacheMutex);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CHostResolver::ProcessResolverControl(CVerboseStr& vout,CXMLElement* p_config)
+{
+    vout << "#" << endl;
+    vout << "# === [resolver] ===============================================================" << endl;
+
+    if( p_config == NULL ){
+        vout << "# Reverse DNS lookups (enabled)                  = " << setw(6) << bool_to_str(Enabled) << "              (default)" << endl;
+        vout << "# Name cache TTL (ttl) [s]                       = " << setw(6) << CacheTTL << "              (default)" << endl;
+        vout << "# Max pending lookups (maxpending)               = " << setw(6) << MaxPending << "              (default)" << endl;
+        return(true);
+    }
+
+    if( p_config->GetAttribute("enabled",Enabled) == true ) {
+        vout << "# Reverse DNS lookups (enabled)                  = " << setw(6) << bool_to_str(Enabled) << endl;
+    } else {
+        vout << "# Reverse DNS lookups (enabled)                  = " << setw(6) << bool_to_str(Enabled) << "              (default)" << endl;
+    }
+
+    if( p_config->GetAttribute("ttl",CacheTTL) == true ) {
+        vout << "# Name cache TTL (ttl) [s]                       = " << setw(6) << CacheTTL << endl;
+    } else {
+        vout << "# Name cache TTL (ttl) [s]                       = " << setw(6) << CacheTTL << "              (default)" << endl;
+    }
+
+    if( p_config->GetAttribute("maxpending",MaxPending) == true ) {
+        vout << "# Max pending lookups (maxpending)               = " << setw(6) << MaxPending << endl;
+    } else {
+        vout << "# Max pending lookups (maxpending)               = " << setw(6) << MaxPending << "              (default)" << endl;
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CHostResolver::IsEnabled(void)
+{
+    return(Enabled);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CHostResolver::Submit(const CSmallString& addr)
+{
+    if( Enabled == false ) return;
+
+    CSmallTimeAndDate time;
+    time.GetActualTimeAndDate();
+    int now = time.GetSecondsFromBeginning();
+
+    string key = string(addr);
+
+    pthread_mutex_lock(&CacheMutex);
+        std::map<std::string,CHostName>::iterator it = Cache.find(key);
+        if( it == Cache.end() ){
+            if( (Cache.size() >= MAX_CACHE_SIZE) && (EvictEntry() == false) ){
+                pthread_mutex_unlock(&CacheMutex);
+                return;
+            }
+            it = Cache.insert(make_pair(key,CHostName())).first;
+            it->second.LRUPos = LRU.insert(LRU.end(),key);
+        } else {
+            // mark the address as recently used
+            LRU.splice(LRU.end(),LRU,it->second.LRUPos);
+        }
+        CHostName& entry = it->second;
+        if( (entry.Pending == false) && (entry.Expiration <= now) && (Queue.size() < MaxPending) ){
+            entry.Pending = true;
+            Queue.push_back(key);
+            pthread_cond_signal(&QueueCond);
+        }
+    pthread_mutex_unlock(&CacheMutex);
+}
+
+//------------------------------------------------------------------------------
+
+bool CHostResolver::EvictEntry(void)
+{
+    // pending entries are never evicted, the resolver thread updates them later
+    std::list<std::string>::iterator it = LRU.begin();
+    while( it != LRU.end() ){
+        std::map<std::string,CHostName>::iterator cit = Cache.find(*it);
+        if( cit->second.Pending == false ){
+            Cache.erase(cit);
+            LRU.erase(it);
+            return(true);
+        }
+        it++;
+    }
+    return(false);
+}
+
+//------------------------------------------------------------------------------
+
+const CSmallString CHostResolver::GetName(const CSmallString& addr)
+{
+    CSmallString name = addr;
+    if( Enabled == false ) return(name);
+
+    pthread_mutex_lock(&CacheMutex);
+        std::map<std::string,CHostName>::iterator it = Cache.find(string(addr));
+        if( (it != Cache.end()) && (it->second.Name != NULL) ){
+            name = it->second.Name;
+        }
+    pthread_mutex_unlock(&CacheMutex);
+
+    return(name);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CHostResolver::ExecuteThread(void)
+{
+    if( Enabled == false ) return;
+
+    for(;;) {
+
+        string addr;
+
+        pthread_mutex_lock(&CacheMutex);
+            while( (ThreadTerminated == false) && Queue.empty() ){
+                pthread_cond_wait(&QueueCond,&CacheMutex);
+            }
+            if( ThreadTerminated ){
+                pthread_mutex_unlock(&CacheMutex);
+                return;
+            }
+            addr = Queue.front();
+            Queue.pop_front();
+        pthread_mutex_unlock(&CacheMutex);
+
+        // lookup is performed outside of the lock
+        CSmallString name = Resolve(addr);
+
+        CSmallTimeAndDate time;
+        time.GetActualTimeAndDate();
+
+        pthread_mutex_lock(&CacheMutex);
+            std::map<std::string,CHostName>::iterator it = Cache.find(addr);
+            if( it != Cache.end() ){
+                CHostName& entry = it->second;
+                // keep the last known name if the lookup failed
+                if( name != NULL ) entry.Name = name;
+                entry.Expiration = time.GetSecondsFromBeginning() + CacheTTL;
+                entry.Pending = false;
+            }
+        pthread_mutex_unlock(&CacheMutex);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CHostResolver::TerminateThread(void)
+{
+    CSmartThread::TerminateThread();
+
+    // wake up the thread waiting for new requests
+    pthread_mutex_lock(&CacheMutex);
+        pthread_cond_broadcast(&QueueCond);
+    pthread_mutex_unlock(&CacheMutex);
+}
+
+//------------------------------------------------------------------------------
+
+CSmallString CHostResolver::Resolve(const std::string& addr)
+{
+    struct addrinfo hints;
+    struct addrinfo *result;
+
+    memset(&hints, 0, sizeof(struct addrinfo));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_NUMERICHOST;    // no lookup here
+
+    if( getaddrinfo(addr.c_str(),NULL,&hints,&result) != 0 ) return("");
+
+    char host[NI_MAXHOST];
+    memset(host,0,NI_MAXHOST);
+
+    int s = getnameinfo(result->ai_addr,result->ai_addrlen,host,NI_MAXHOST-1,NULL,0,NI_NAMEREQD);
+    freeaddrinfo(result);
+
+    if( s != 0 ) return("");
+    return(host);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,108 @@
+#ifndef HostResolverH
+#define HostResolverH
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SmartThread.hpp>
+#include <SmallString.hpp>
+#include <VerboseStr.hpp>
+#include <map>
+#include <list>
+#include <string>
+#include <pthread.h>
+
+//------------------------------------------------------------------------------
+
+class CXMLElement;
+
+//------------------------------------------------------------------------------
+
+//! asynchronous reverse DNS lookup of peer addresses
+/*! \ingroup eserver
+
+  [resolver]
+  enabled           (on/off) - determine if reverse lookups are performed
+  ttl               (int)    - time in seconds for which resolved names are cached
+  maxpending        (int)    - max number of addresses waiting for lookup
+
+  requests are only queued, the caller never waits for the resolver
+  the cache is limited, the least recently submitted address is evicted when it is full
+*/
+class CHostResolver : public CSmartThread {
+public:
+// constructor -----------------------------------------------------------------
+    CHostResolver(void);
+    ~CHostResolver(void);
+
+    //! read resolver setup
+    bool ProcessResolverControl(CVerboseStr& vout,CXMLElement* p_config);
+
+    //! is the resolver enabled?
+    bool IsEnabled(void);
+
+// executive methods -----------------------------------------------------------
+    //! stop the resolver thread (it is woken up if it waits for requests)
+    void TerminateThread(void);
+
+    //! queue lookup of numeric address if it is not cached
+    void Submit(const CSmallString& addr);
+
+    //! get cached name or the numeric address if the name is not known
+    const CSmallString GetName(const CSmallString& addr);
+
+// section of private data -----------------------------------------------------
+private:
+    class CHostName {
+    public:
+        CHostName(void);
+    public:
+        CSmallString    Name;
+        int             Expiration;
+        bool            Pending;
+        std::list<std::string>::iterator    LRUPos;
+    };
+
+    bool                                Enabled;
+    int                                 CacheTTL;   // in seconds
+    unsigned int                        MaxPending;
+
+    pthread_mutex_t                     CacheMutex;
+    pthread_cond_t                      QueueCond;  // signalled when Queue is not empty
+    std::map<std::string,CHostName>     Cache;
+    std::list<std::string>              LRU;        // least recently submitted first
+    std::list<std::string>              Queue;
+
+    // remove the least recently submitted entry that is not waiting for lookup
+    bool EvictEntry(void);
+
+    // main loop
+    virtual void ExecuteThread(void);
+
+    // blocking lookup - executed only by the resolver thread
+    static CSmallString Resolve(const std::string& addr);
+};
+
+//------------------------------------------------------------------------------
+
+extern CHostResolver HostResolver;
+
+//------------------------------------------------------------------------------
+
+#endif
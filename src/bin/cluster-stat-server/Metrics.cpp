@@ -0,0 +1,283 @@
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <Metrics.hpp>
+#include <string.h>
+#include <time.h>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+CMetrics Metrics;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CMetricCounter::CMetricCounter(void)
+    : Value(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+void CMetricCounter::Inc(unsigned long value)
+{
+    Value.fetch_add(value,boost::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+
+unsigned long CMetricCounter::Get(void) const
+{
+    return(Value.load(boost::memory_order_relaxed));
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CMetricGauge::CMetricGauge(void)
+    : Value(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+void CMetricGauge::Set(long value)
+{
+    Value.store(value,boost::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+
+void CMetricGauge::SetMax(long value)
+{
+    long current = Value.load(boost::memory_order_relaxed);
+    while( value > current ){
+        if( Value.compare_exchange_weak(current,value,boost::memory_order_relaxed) ) break;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+long CMetricGauge::Get(void) const
+{
+    return(Value.load(boost::memory_order_relaxed));
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+// upper bounds in seconds - from mutex waits to external commands
+const double CMetricHistogram::Bounds[METRIC_NUM_OF_BUCKETS] = {
+    0.00001, 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05,
+    0.1, 0.5, 1.0, 5.0, 10.0, 60.0, 300.0
+};
+
+//------------------------------------------------------------------------------
+
+CMetricHistogram::CMetricHistogram(void)
+    : Sum(0)
+{
+    for(int i=0; i <= METRIC_NUM_OF_BUCKETS; i++){
+        Buckets[i].store(0,boost::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CMetricHistogram::Observe(double value)
+{
+    int i = 0;
+    while( (i < METRIC_NUM_OF_BUCKETS) && (value > Bounds[i]) ) i++;
+    Buckets[i].fetch_add(1,boost::memory_order_relaxed);
+    if( value > 0 ){
+        Sum.fetch_add((unsigned long)(value*1.0e6),boost::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+unsigned long CMetricHistogram::GetCount(void) const
+{
+    unsigned long count = 0;
+    for(int i=0; i <= METRIC_NUM_OF_BUCKETS; i++){
+        count += Buckets[i].load(boost::memory_order_relaxed);
+    }
+    return(count);
+}
+
+//------------------------------------------------------------------------------
+
+double CMetricHistogram::GetSum(void) const
+{
+    return(Sum.load(boost::memory_order_relaxed) * 1.0e-6);
+}
+
+//------------------------------------------------------------------------------
+
+void CMetricHistogram::Print(std::ostream& str,const char* p_name,const char* p_labels) const
+{
+    string labels;
+    if( p_labels != NULL ){
+        labels = p_labels;
+        labels += ",";
+    }
+
+    // buckets are cumulative in the output
+    unsigned long count = 0;
+    for(int i=0; i < METRIC_NUM_OF_BUCKETS; i++){
+        count += Buckets[i].load(boost::memory_order_relaxed);
+        str << p_name << "_bucket{" << labels << "le=\"" << Bounds[i] << "\"} " << count << "\n";
+    }
+    count += Buckets[METRIC_NUM_OF_BUCKETS].load(boost::memory_order_relaxed);
+    str << p_name << "_bucket{" << labels << "le=\"+Inf\"} " << count << "\n";
+
+    if( p_labels != NULL ){
+        str << p_name << "_sum{" << p_labels << "} " << Sum.load(boost::memory_order_relaxed) * 1.0e-6 << "\n";
+        str << p_name << "_count{" << p_labels << "} " << count << "\n";
+    } else {
+        str << p_name << "_sum " << Sum.load(boost::memory_order_relaxed) * 1.0e-6 << "\n";
+        str << p_name << "_count " << count << "\n";
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+const char* CMetrics::DropReasons[EMD_NUM_OF_REASONS] = {
+    "unknown_type", "address", "checksum", "too_many_nodes", "unknown_state"
+};
+
+const char* CMetrics::Actions[EMA_NUM_OF_ACTIONS] = {
+    "loggedusers", "allseats", "remote", "debug", "watch", "metrics", "unknown"
+};
+
+//------------------------------------------------------------------------------
+
+void CMetrics::Print(std::ostream& str)
+{
+    str << "# HELP clusterstat_datagrams_total Received stat packets.\n";
+    str << "# TYPE clusterstat_datagrams_total counter\n";
+    str << "clusterstat_datagrams_total " << Datagrams.Get() << "\n";
+
+    str << "# HELP clusterstat_datagrams_accepted_total Accepted datagrams and heartbeats.\n";
+    str << "# TYPE clusterstat_datagrams_accepted_total counter\n";
+    str << "clusterstat_datagrams_accepted_total " << AcceptedDatagrams.Get() << "\n";
+
+    str << "# HELP clusterstat_heartbeats_total Accepted heartbeats.\n";
+    str << "# TYPE clusterstat_heartbeats_total counter\n";
+    str << "clusterstat_heartbeats_total " << Heartbeats.Get() << "\n";
+
+    str << "# HELP clusterstat_legacy_datagrams_total Accepted version 3 datagrams.\n";
+    str << "# TYPE clusterstat_legacy_datagrams_total counter\n";
+    str << "clusterstat_legacy_datagrams_total " << LegacyDatagrams.Get() << "\n";
+
+    str << "# HELP clusterstat_receive_batches_total Number of recvmmsg calls.\n";
+    str << "# TYPE clusterstat_receive_batches_total counter\n";
+    str << "clusterstat_receive_batches_total " << ReceiveBatches.Get() << "\n";
+
+    str << "# HELP clusterstat_datagrams_dropped_total Dropped stat packets by reason.\n";
+    str << "# TYPE clusterstat_datagrams_dropped_total counter\n";
+    for(int i=0; i < EMD_NUM_OF_REASONS; i++){
+        str << "clusterstat_datagrams_dropped_total{reason=\"" << DropReasons[i] << "\"} " << DroppedDatagrams[i].Get() << "\n";
+    }
+
+    str << "# HELP clusterstat_resync_requests_total Full datagrams requested for heartbeats with unknown state.\n";
+    str << "# TYPE clusterstat_resync_requests_total counter\n";
+    str << "clusterstat_resync_requests_total " << ResyncRequests.Get() << "\n";
+
+    str << "# HELP clusterstat_registry_lock_wait_seconds Time spent waiting for registry shard locks.\n";
+    str << "# TYPE clusterstat_registry_lock_wait_seconds histogram\n";
+    RegistryLockWait.Print(str,"clusterstat_registry_lock_wait_seconds",NULL);
+
+    str << "# HELP clusterstat_requests_total FastCGI requests by action.\n";
+    str << "# TYPE clusterstat_requests_total counter\n";
+    for(int i=0; i < EMA_NUM_OF_ACTIONS; i++){
+        str << "clusterstat_requests_total{action=\"" << Actions[i] << "\"} " << Requests[i].Get() << "\n";
+    }
+
+    str << "# HELP clusterstat_requests_failed_total Failed FastCGI requests by action.\n";
+    str << "# TYPE clusterstat_requests_failed_total counter\n";
+    for(int i=0; i < EMA_NUM_OF_ACTIONS; i++){
+        str << "clusterstat_requests_failed_total{action=\"" << Actions[i] << "\"} " << FailedRequests[i].Get() << "\n";
+    }
+
+    str << "# HELP clusterstat_request_duration_seconds FastCGI request processing time by action.\n";
+    str << "# TYPE clusterstat_request_duration_seconds histogram\n";
+    for(int i=0; i < EMA_NUM_OF_ACTIONS; i++){
+        string labels = string("action=\"") + Actions[i] + "\"";
+        RequestDuration[i].Print(str,"clusterstat_request_duration_seconds",labels.c_str());
+    }
+
+    str << "# HELP clusterstat_pbs_poll_duration_seconds Duration of batch system update cycles.\n";
+    str << "# TYPE clusterstat_pbs_poll_duration_seconds histogram\n";
+    PBSPollDuration.Print(str,"clusterstat_pbs_poll_duration_seconds",NULL);
+
+    str << "# HELP clusterstat_pbs_poll_max_duration_seconds Longest batch system update cycle.\n";
+    str << "# TYPE clusterstat_pbs_poll_max_duration_seconds gauge\n";
+    str << "clusterstat_pbs_poll_max_duration_seconds " << PBSPollMaxDuration.Get() * 1.0e-6 << "\n";
+
+    str << "# HELP clusterstat_pbs_polls_failed_total Failed batch system update cycles.\n";
+    str << "# TYPE clusterstat_pbs_polls_failed_total counter\n";
+    str << "clusterstat_pbs_polls_failed_total " << FailedPBSPolls.Get() << "\n";
+
+    str << "# HELP clusterstat_pbs_connects_total Connection attempts to the batch server.\n";
+    str << "# TYPE clusterstat_pbs_connects_total counter\n";
+    str << "clusterstat_pbs_connects_total " << PBSConnects.Get() << "\n";
+
+    str << "# HELP clusterstat_pbs_connects_failed_total Failed connection attempts to the batch server.\n";
+    str << "# TYPE clusterstat_pbs_connects_failed_total counter\n";
+    str << "clusterstat_pbs_connects_failed_total " << FailedPBSConnects.Get() << "\n";
+
+    str << "# HELP clusterstat_command_duration_seconds Runtime of power on and start RDSK commands.\n";
+    str << "# TYPE clusterstat_command_duration_seconds histogram\n";
+    CommandDuration.Print(str,"clusterstat_command_duration_seconds",NULL);
+}
+
+//------------------------------------------------------------------------------
+
+EMetricAction CMetrics::GetAction(const char* p_name)
+{
+    if( (p_name == NULL) || (p_name[0] == '\0') ) return(EMA_LOGGEDUSERS);   // default action
+    for(int i=0; i < EMA_UNKNOWN; i++){
+        if( strcmp(p_name,Actions[i]) == 0 ) return((EMetricAction)i);
+    }
+    return(EMA_UNKNOWN);
+}
+
+//------------------------------------------------------------------------------
+
+double CMetrics::GetTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return(ts.tv_sec + ts.tv_nsec * 1.0e-9);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,161 @@
+#ifndef MetricsH
+#define MetricsH
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <boost/atomic.hpp>
+#include <ostream>
+
+//------------------------------------------------------------------------------
+
+//! monotonically increasing counter, it can be updated from any thread without locks
+
+class CMetricCounter {
+public:
+    CMetricCounter(void);
+
+    void            Inc(unsigned long value=1);
+    unsigned long   Get(void) const;
+
+private:
+    boost::atomic<unsigned long>    Value;
+};
+
+//------------------------------------------------------------------------------
+
+//! value that can go up and down
+
+class CMetricGauge {
+public:
+    CMetricGauge(void);
+
+    void            Set(long value);
+    void            SetMax(long value);     // keep the highest value
+    long            Get(void) const;
+
+private:
+    boost::atomic<long>             Value;
+};
+
+//------------------------------------------------------------------------------
+
+#define METRIC_NUM_OF_BUCKETS   14
+
+//! histogram of durations in seconds with fixed buckets
+
+class CMetricHistogram {
+public:
+    CMetricHistogram(void);
+
+    //! record duration in seconds
+    void    Observe(double value);
+
+    //! number of observations
+    unsigned long GetCount(void) const;
+
+    //! sum of observations in seconds
+    double GetSum(void) const;
+
+    //! print in Prometheus text format, p_labels can be NULL
+    void    Print(std::ostream& str,const char* p_name,const char* p_labels) const;
+
+private:
+    static const double             Bounds[METRIC_NUM_OF_BUCKETS];
+    boost::atomic<unsigned long>    Buckets[METRIC_NUM_OF_BUCKETS+1];   // the last one is +Inf
+    boost::atomic<unsigned long>    Sum;                                // in microseconds
+};
+
+//------------------------------------------------------------------------------
+
+enum EMetricDrop {
+    EMD_UNKNOWN_TYPE        = 0,    // short or unknown packet
+    EMD_ADDRESS             = 1,    // unable to get peer address
+    EMD_CHECKSUM            = 2,    // corrupted packet
+    EMD_TOO_MANY_NODES      = 3,    // registry is full
+    EMD_UNKNOWN_STATE       = 4,    // heartbeat does not match registered state
+    EMD_NUM_OF_REASONS      = 5
+};
+
+//------------------------------------------------------------------------------
+
+enum EMetricAction {
+    EMA_LOGGEDUSERS         = 0,
+    EMA_ALLSEATS            = 1,
+    EMA_REMOTE              = 2,
+    EMA_DEBUG               = 3,
+    EMA_WATCH               = 4,
+    EMA_METRICS             = 5,
+    EMA_UNKNOWN             = 6,
+    EMA_NUM_OF_ACTIONS      = 7
+};
+
+//------------------------------------------------------------------------------
+
+//! server metrics
+
+class CMetrics {
+public:
+// ingestion -------------------------------------------------------------------
+    CMetricCounter      Datagrams;              // all received packets
+    CMetricCounter      AcceptedDatagrams;      // datagrams and heartbeats
+    CMetricCounter      Heartbeats;             // subgroup of AcceptedDatagrams
+    CMetricCounter      LegacyDatagrams;        // subgroup of AcceptedDatagrams, v3 datagrams
+    CMetricCounter      ReceiveBatches;         // number of recvmmsg calls
+    CMetricCounter      DroppedDatagrams[EMD_NUM_OF_REASONS];
+    CMetricCounter      ResyncRequests;         // replies to heartbeats with unknown state
+
+// registry --------------------------------------------------------------------
+    CMetricHistogram    RegistryLockWait;
+
+// requests --------------------------------------------------------------------
+    CMetricCounter      Requests[EMA_NUM_OF_ACTIONS];
+    CMetricCounter      FailedRequests[EMA_NUM_OF_ACTIONS];
+    CMetricHistogram    RequestDuration[EMA_NUM_OF_ACTIONS];
+
+// batch system and commands ---------------------------------------------------
+    CMetricHistogram    PBSPollDuration;
+    CMetricGauge        PBSPollMaxDuration;     // in microseconds
+    CMetricCounter      FailedPBSPolls;
+    CMetricCounter      PBSConnects;
+    CMetricCounter      FailedPBSConnects;
+    CMetricHistogram    CommandDuration;
+
+// executive methods -----------------------------------------------------------
+    //! print all metrics in Prometheus text format
+    void Print(std::ostream& str);
+
+    //! get action id from its name
+    static EMetricAction GetAction(const char* p_name);
+
+    //! monotonic time in seconds
+    static double GetTime(void);
+
+private:
+    static const char*  DropReasons[EMD_NUM_OF_REASONS];
+    static const char*  Actions[EMA_NUM_OF_ACTIONS];
+};
+
+//------------------------------------------------------------------------------
+
+extern CMetrics Metrics;
+
+//------------------------------------------------------------------------------
+
+#endif
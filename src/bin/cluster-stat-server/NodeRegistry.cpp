@@ -0,0 +1,583 @@
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <NodeRegistry.hpp>
+#include <StatChecksum.hpp>
+#include <ErrorSystem.hpp>
+#include <SmallTimeAndDate.hpp>
+#include <Metrics.hpp>
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CCompNode::CCompNode(void)
+{
+    InPowerOnMode = false;
+    PowerOnTime = 0;
+
+    InStartVNCMode = false;
+    StartVNCTime = 0;
+
+    PowerStat = EPS_UNKNOWN;
+    NCPUs = 0;
+    NGPUs = 0;
+
+    Basic.Clear();
+    StateHash = 0;
+    LastSeen = 0;
+}
+
+//------------------------------------------------------------------------------
+
+CCompNode::CCompNode(const CCompNode& src)
+{
+    *this = src;
+}
+
+//------------------------------------------------------------------------------
+
+CCompNode& CCompNode::operator=(const CCompNode& src)
+{
+    Name            = src.Name;
+    Basic           = src.Basic;
+    StateHash       = src.StateHash;
+    LastSeen        = src.LastSeen.load(boost::memory_order_relaxed);
+    InPowerOnMode   = src.InPowerOnMode;
+    PowerOnTime     = src.PowerOnTime;
+    InStartVNCMode  = src.InStartVNCMode;
+    StartVNCTime    = src.StartVNCTime;
+    PowerStat       = src.PowerStat;
+    NCPUs           = src.NCPUs;
+    NGPUs           = src.NGPUs;
+    return(*this);
+}
+
+//------------------------------------------------------------------------------
+
+int CCompNode::GetTimeStamp(void) const
+{
+    int last_seen = LastSeen.load(boost::memory_order_relaxed);
+    if( last_seen > Basic.GetTimeStamp() ) return(last_seen);
+    return(Basic.GetTimeStamp());
+}
+
+//------------------------------------------------------------------------------
+
+void CCompNode::Clear(void)
+{
+    InPowerOnMode = false;
+    PowerOnTime = 0;
+
+    InStartVNCMode = false;
+    StartVNCTime = 0;
+
+    CSmallString node = Basic.GetNodeName();
+    Basic.Clear();
+    Basic.SetNodeName(node);
+    StateHash = 0;
+    LastSeen = 0;
+}
+
+//------------------------------------------------------------------------------
+
+CBatchNodeInfo::CBatchNodeInfo(void)
+{
+    PowerStat = EPS_UNKNOWN;
+    NCPUs = -1;
+    NGPUs = -1;
+}
+
+//------------------------------------------------------------------------------
+
+CClusterSnapshot::CClusterSnapshot(void)
+{
+    Generation      = 0;
+    CreationTime    = 0;
+}
+
+//------------------------------------------------------------------------------
+
+static bool CompareNodeNames(const CCompNodeConstPtr& left,const CCompNodeConstPtr& right)
+{
+    return( left->Name < right->Name );
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CNodeRegistry::CNodeRegistry(void)
+{
+    NumOfNodes  = 0;
+    MaxNodes    = 100;
+    Generation  = 1;
+    Snapshot    = CClusterSnapshotPtr(new CClusterSnapshot);
+}
+
+//------------------------------------------------------------------------------
+
+void CNodeRegistry::SetMaxNodes(unsigned int max_nodes)
+{
+    MaxNodes = max_nodes;
+}
+
+//------------------------------------------------------------------------------
+
+void CNodeRegistry::AddNode(const std::string& name)
+{
+    CNodeShard& shard = GetShard(name);
+
+    LockShard(shard);
+        if( shard.Nodes.count(name) == 0 ){
+            CountMutex.Lock();
+                NumOfNodes++;
+            CountMutex.Unlock();
+            CCompNodePtr node(new CCompNode);
+            node->Name = name;
+            node->Basic.SetNodeName(name.c_str());
+            shard.Nodes[name] = node;
+            Changed();
+        }
+    shard.Mutex.Unlock();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CNodeRegistry::RegisterNode(const CStatDatagram& dtg)
+{
+    // prepare everything outside of the lock
+    string          name = string(dtg.GetNodeName());
+    CCompNodePtr    node(new CCompNode);
+
+    node->Name          = name;
+    node->Basic         = dtg;
+    node->StateHash     = dtg.GetStateHash();
+
+    CNodeShard& shard = GetShard(name);
+
+    LockShard(shard);
+
+    std::map<std::string,CCompNodePtr>::iterator it = shard.Nodes.find(name);
+
+    if( it != shard.Nodes.end() ){
+        // keep batch system and remote access data
+        const CCompNode& old = *it->second;
+        node->InStartVNCMode    = old.InStartVNCMode;
+        node->StartVNCTime      = old.StartVNCTime;
+        node->PowerStat         = old.PowerStat;
+        node->NCPUs             = old.NCPUs;
+        node->NGPUs             = old.NGPUs;
+        // power on status is cleared
+        if( (old.StateHash != node->StateHash) || (old.GetTimeStamp() == 0) || old.InPowerOnMode ){
+            Changed();
+        }
+        it->second = node;
+    } else {
+        // new registration
+        if( ReserveNode() == false ){
+            shard.Mutex.Unlock();
+            ES_ERROR("too many nodes - skiping new registration");
+            return(false);
+        }
+        shard.Nodes[name] = node;
+        Changed();
+    }
+
+    shard.Mutex.Unlock();
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CNodeRegistry::RefreshNode(const CStatHeartbeat& hb)
+{
+    string name = string(hb.GetNodeName());
+
+    CNodeShard& shard = GetShard(name);
+
+    LockShard(shard);
+
+    std::map<std::string,CCompNodePtr>::iterator it = shard.Nodes.find(name);
+
+    // the server does not have the same state as the client, wait for full datagram
+    if( (it == shard.Nodes.end()) || (it->second->StateHash != hb.GetStateHash()) ||
+        (it->second->GetTimeStamp() == 0) ){
+        shard.Mutex.Unlock();
+        return(false);
+    }
+
+    // common case - only the timestamp is updated in place, the node is not copied
+    if( it->second->InPowerOnMode == false ){
+        int last_seen = it->second->LastSeen.load(boost::memory_order_relaxed);
+        while( hb.GetTimeStamp() > last_seen ){
+            if( it->second->LastSeen.compare_exchange_weak(last_seen,hb.GetTimeStamp(),boost::memory_order_relaxed) ) break;
+        }
+        shard.Mutex.Unlock();
+        return(true);
+    }
+
+    // clear power on status - it changes the reported state
+    CCompNodePtr node = CloneNode(shard,name);
+
+    if( hb.GetTimeStamp() > node->LastSeen ){
+        node->LastSeen = hb.GetTimeStamp();
+    }
+    node->InPowerOnMode  = false;
+    node->PowerOnTime    = 0;
+
+    it->second = node;
+    Changed();
+
+    shard.Mutex.Unlock();
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CNodeRegistry::RestoreNode(const CCompNode& saved)
+{
+    // prepare everything outside of the lock
+    string          name = string(saved.Basic.GetNodeName());
+    CCompNodePtr    node(new CCompNode(saved));
+
+    node->Name          = name;
+    node->StateHash     = saved.Basic.GetStateHash();
+
+    CNodeShard& shard = GetShard(name);
+
+    LockShard(shard);
+
+    std::map<std::string,CCompNodePtr>::iterator it = shard.Nodes.find(name);
+
+    if( it != shard.Nodes.end() ){
+        const CCompNode& old = *it->second;
+        // the node has already reported itself
+        if( (old.GetTimeStamp() != 0) && (old.GetTimeStamp() >= saved.GetTimeStamp()) ){
+            shard.Mutex.Unlock();
+            return(false);
+        }
+        // keep batch system data if they are already known
+        if( old.PowerStat != EPS_UNKNOWN ){
+            node->PowerStat     = old.PowerStat;
+            node->NCPUs         = old.NCPUs;
+            node->NGPUs         = old.NGPUs;
+        }
+        it->second = node;
+    } else {
+        if( ReserveNode() == false ){
+            shard.Mutex.Unlock();
+            ES_ERROR("too many nodes - skiping restored node");
+            return(false);
+        }
+        shard.Nodes[name] = node;
+    }
+
+    Changed();
+
+    shard.Mutex.Unlock();
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CNodeRegistry::SetPowerOnMode(const std::string& name,bool set,int time)
+{
+    CNodeShard& shard = GetShard(name);
+
+    LockShard(shard);
+
+    if( (shard.Nodes.count(name) == 0) && (ReserveNode() == false) ){
+        shard.Mutex.Unlock();
+        ES_ERROR("too many nodes - skiping new registration");
+        return;
+    }
+
+    CCompNodePtr node = CloneNode(shard,name);
+    node->InPowerOnMode = set;
+    node->PowerOnTime   = time;
+    shard.Nodes[name]   = node;
+    Changed();
+
+    shard.Mutex.Unlock();
+}
+
+//------------------------------------------------------------------------------
+
+void CNodeRegistry::SetStartVNCMode(const std::string& name,bool set,int time)
+{
+    CNodeShard& shard = GetShard(name);
+
+    LockShard(shard);
+
+    if( (shard.Nodes.count(name) == 0) && (ReserveNode() == false) ){
+        shard.Mutex.Unlock();
+        ES_ERROR("too many nodes - skiping new registration");
+        return;
+    }
+
+    CCompNodePtr node = CloneNode(shard,name);
+    node->InStartVNCMode = set;
+    node->StartVNCTime   = time;
+    shard.Nodes[name]    = node;
+    Changed();
+
+    shard.Mutex.Unlock();
+}
+
+//------------------------------------------------------------------------------
+
+void CNodeRegistry::SetBatchInfo(const std::vector<CBatchNodeInfo>& infos)
+{
+    // group nodes by shards
+    std::vector<const CBatchNodeInfo*> groups[NODE_REGISTRY_SHARDS];
+    for(size_t i=0; i < infos.size(); i++){
+        groups[GetShardIndex(infos[i].Name)].push_back(&infos[i]);
+    }
+
+    bool changed = false;
+
+    for(unsigned int k=0; k < NODE_REGISTRY_SHARDS; k++){
+        if( groups[k].empty() ) continue;
+        CNodeShard& shard = Shards[k];
+
+        LockShard(shard);
+        for(size_t i=0; i < groups[k].size(); i++){
+            const CBatchNodeInfo& info = *groups[k][i];
+            std::map<std::string,CCompNodePtr>::iterator it = shard.Nodes.find(info.Name);
+            if( it == shard.Nodes.end() ) continue;
+
+            // keep resources that were not reported
+            int ncpus = info.NCPUs >= 0 ? info.NCPUs : it->second->NCPUs;
+            int ngpus = info.NGPUs >= 0 ? info.NGPUs : it->second->NGPUs;
+
+            // unchanged nodes are not copied
+            if( (it->second->PowerStat != info.PowerStat) || (it->second->NCPUs != ncpus) || (it->second->NGPUs != ngpus) ){
+                CCompNodePtr node = CloneNode(shard,info.Name);
+                node->PowerStat = info.PowerStat;
+                node->NCPUs     = ncpus;
+                node->NGPUs     = ngpus;
+                it->second = node;
+                changed = true;
+            }
+        }
+        shard.Mutex.Unlock();
+    }
+
+    if( changed ) Changed();
+}
+
+//------------------------------------------------------------------------------
+
+void CNodeRegistry::ClearNode(const std::string& name,int timestamp)
+{
+    CNodeShard& shard = GetShard(name);
+
+    LockShard(shard);
+        std::map<std::string,CCompNodePtr>::iterator it = shard.Nodes.find(name);
+        // the node can be updated in the meantime, already cleared nodes are not copied
+        if( (it != shard.Nodes.end()) && (it->second->GetTimeStamp() == timestamp) &&
+            ((timestamp != 0) || it->second->InPowerOnMode || it->second->InStartVNCMode) ){
+            CCompNodePtr node = CloneNode(shard,name);
+            node->Clear();
+            it->second = node;
+            Changed();
+        }
+    shard.Mutex.Unlock();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CCompNodeConstPtr CNodeRegistry::FindNode(const std::string& name)
+{
+    CCompNodeConstPtr node;
+
+    CNodeShard& shard = GetShard(name);
+
+    LockShard(shard);
+        std::map<std::string,CCompNodePtr>::iterator it = shard.Nodes.find(name);
+        if( it != shard.Nodes.end() ) node = it->second;
+    shard.Mutex.Unlock();
+
+    return(node);
+}
+
+//------------------------------------------------------------------------------
+
+void CNodeRegistry::GetNodes(std::vector<CCompNodeConstPtr>& nodes)
+{
+    nodes.clear();
+    nodes.reserve(GetNumOfNodes());
+
+    // only pointers are copied under the lock
+    for(int i=0; i < NODE_REGISTRY_SHARDS; i++){
+        CNodeShard& shard = Shards[i];
+        LockShard(shard);
+            std::map<std::string,CCompNodePtr>::iterator it = shard.Nodes.begin();
+            std::map<std::string,CCompNodePtr>::iterator ie = shard.Nodes.end();
+            while( it != ie ){
+                nodes.push_back(it->second);
+                it++;
+            }
+        shard.Mutex.Unlock();
+    }
+
+    std::sort(nodes.begin(),nodes.end(),CompareNodeNames);
+}
+
+//------------------------------------------------------------------------------
+
+size_t CNodeRegistry::GetNumOfNodes(void)
+{
+    CountMutex.Lock();
+        size_t num = NumOfNodes;
+    CountMutex.Unlock();
+    return(num);
+}
+
+//------------------------------------------------------------------------------
+
+unsigned int CNodeRegistry::GetGeneration(void)
+{
+    CountMutex.Lock();
+        unsigned int gen = Generation;
+    CountMutex.Unlock();
+    return(gen);
+}
+
+//------------------------------------------------------------------------------
+
+CClusterSnapshotPtr CNodeRegistry::GetSnapshot(void)
+{
+    CSmallTimeAndDate time;
+    time.GetActualTimeAndDate();
+    int now = time.GetSecondsFromBeginning();
+
+    // fast path - the published snapshot is current
+    CClusterSnapshotPtr snapshot = boost::atomic_load(&Snapshot);
+    if( (snapshot->Generation == GetGeneration()) && (now - snapshot->CreationTime < NODE_SNAPSHOT_TTL) ){
+        return(snapshot);
+    }
+
+    SnapshotMutex.Lock();
+
+    // other reader could rebuild it in the meantime
+    snapshot = boost::atomic_load(&Snapshot);
+    unsigned int gen = GetGeneration();
+    if( (snapshot->Generation != gen) || (now - snapshot->CreationTime >= NODE_SNAPSHOT_TTL) ){
+        boost::shared_ptr<CClusterSnapshot> new_snapshot(new CClusterSnapshot);
+        // the generation is read before nodes, the snapshot can be only newer
+        new_snapshot->Generation    = gen;
+        new_snapshot->CreationTime  = now;
+        GetNodes(new_snapshot->Nodes);
+        snapshot = new_snapshot;
+        boost::atomic_store(&Snapshot,snapshot);
+    }
+
+    SnapshotMutex.Unlock();
+
+    return(snapshot);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CNodeRegistry::CNodeShard& CNodeRegistry::GetShard(const std::string& name)
+{
+    return(Shards[GetShardIndex(name)]);
+}
+
+//------------------------------------------------------------------------------
+
+unsigned int CNodeRegistry::GetShardIndex(const std::string& name)
+{
+    unsigned int hash = StatCRC32C(0,name.c_str(),name.size());
+    return(hash % NODE_REGISTRY_SHARDS);
+}
+
+//------------------------------------------------------------------------------
+
+CCompNodePtr CNodeRegistry::CloneNode(CNodeShard& shard,const std::string& name)
+{
+    CCompNodePtr node(new CCompNode);
+
+    std::map<std::string,CCompNodePtr>::iterator it = shard.Nodes.find(name);
+    if( it != shard.Nodes.end() ){
+        *node = *it->second;
+    } else {
+        node->Name = name;
+        node->Basic.SetNodeName(name.c_str());
+    }
+
+    return(node);
+}
+
+//------------------------------------------------------------------------------
+
+void CNodeRegistry::LockShard(CNodeShard& shard)
+{
+    double start = CMetrics::GetTime();
+    shard.Mutex.Lock();
+    Metrics.RegistryLockWait.Observe(CMetrics::GetTime() - start);
+}
+
+//------------------------------------------------------------------------------
+
+void CNodeRegistry::Changed(void)
+{
+    CountMutex.Lock();
+        Generation++;
+    CountMutex.Unlock();
+}
+
+//------------------------------------------------------------------------------
+
+bool CNodeRegistry::ReserveNode(void)
+{
+    bool result = false;
+
+    CountMutex.Lock();
+        if( NumOfNodes < MaxNodes ){
+            NumOfNodes++;
+            result = true;
+        }
+    CountMutex.Unlock();
+
+    return(result);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
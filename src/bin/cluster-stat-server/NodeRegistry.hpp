@@ -0,0 +1,214 @@
+#ifndef NodeRegistryH
+#define NodeRegistryH
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <StatDatagram.hpp>
+#include <SimpleMutex.hpp>
+#include <map>
+#include <vector>
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+
+//------------------------------------------------------------------------------
+
+enum EPowerStat {
+    EPS_DOWN,
+    EPS_UP,
+    EPS_MAINTANANCE,
+    EPS_UNKNOWN,
+};
+
+//------------------------------------------------------------------------------
+
+class CCompNode {
+public:
+    CCompNode(void);
+    CCompNode(const CCompNode& src);
+    CCompNode& operator=(const CCompNode& src);
+    void Clear(void);
+
+    //! time of the last datagram or heartbeat
+    int GetTimeStamp(void) const;
+
+public:
+    std::string     Name;           // registry key
+    CStatDatagram   Basic;
+    unsigned int    StateHash;      // hash of Basic, see CStatHeartbeat
+
+    // time of the last heartbeat, it is updated in place by CNodeRegistry::RefreshNode
+    // thus heartbeats do not copy the node
+    mutable boost::atomic<int>  LastSeen;
+
+    bool            InPowerOnMode;
+    int             PowerOnTime;
+
+    bool            InStartVNCMode;
+    int             StartVNCTime;
+
+    EPowerStat      PowerStat;
+    int             NCPUs;
+    int             NGPUs;
+};
+
+//! node state reported by the batch system
+
+class CBatchNodeInfo {
+public:
+    CBatchNodeInfo(void);
+public:
+    std::string     Name;
+    EPowerStat      PowerStat;
+    int             NCPUs;          // negative if not reported
+    int             NGPUs;          // negative if not reported
+};
+
+//------------------------------------------------------------------------------
+
+typedef boost::shared_ptr<CCompNode>        CCompNodePtr;
+typedef boost::shared_ptr<const CCompNode>  CCompNodeConstPtr;
+
+//------------------------------------------------------------------------------
+
+//! immutable state of the cluster published for readers
+
+class CClusterSnapshot {
+public:
+    CClusterSnapshot(void);
+public:
+    unsigned int                    Generation;     // registry generation
+    int                             CreationTime;
+    std::vector<CCompNodeConstPtr>  Nodes;          // sorted by name
+};
+
+typedef boost::shared_ptr<const CClusterSnapshot>   CClusterSnapshotPtr;
+
+//------------------------------------------------------------------------------
+
+#define NODE_REGISTRY_SHARDS    16
+
+// max age of snapshot in seconds, heartbeats update only timestamps
+// and do not change the generation
+#define NODE_SNAPSHOT_TTL       5
+
+//! registry of computational nodes
+/*!
+  nodes are distributed into shards according to the hash of their names,
+  each shard has its own lock, which is held only for a short time
+
+  published nodes are never modified (copy-on-write), readers thus obtain
+  pointers to nodes and render them without any lock
+
+  generation is increased by every change of reported state,
+  the snapshot is rebuilt by the first reader after the change
+*/
+
+class CNodeRegistry {
+public:
+// constructor -----------------------------------------------------------------
+    CNodeRegistry(void);
+
+// setup -----------------------------------------------------------------------
+    //! set max number of nodes
+    void SetMaxNodes(unsigned int max_nodes);
+
+    //! add node without any data (e.g. from config)
+    void AddNode(const std::string& name);
+
+// datagram ingestion ----------------------------------------------------------
+    //! register node, false if there are too many nodes
+    bool RegisterNode(const CStatDatagram& dtg);
+
+    //! refresh timestamp of registered node, false if the node state is not known
+    bool RefreshNode(const CStatHeartbeat& hb);
+
+    //! restore node saved by CNodeStateStore, newer data are kept
+    bool RestoreNode(const CCompNode& saved);
+
+// node state ------------------------------------------------------------------
+    //! set power on mode, the node is added if it does not exist
+    void SetPowerOnMode(const std::string& name,bool set,int time);
+
+    //! set start VNC mode, the node is added if it does not exist
+    void SetStartVNCMode(const std::string& name,bool set,int time);
+
+    //! merge batch system info, unknown nodes are ignored
+    /*!
+      each shard is locked only once for all its nodes
+    */
+    void SetBatchInfo(const std::vector<CBatchNodeInfo>& infos);
+
+    //! clear node data if it was not updated since timestamp
+    void ClearNode(const std::string& name,int timestamp);
+
+// readers ---------------------------------------------------------------------
+    //! find node, NULL if it does not exist
+    CCompNodeConstPtr FindNode(const std::string& name);
+
+    //! get all nodes sorted by name
+    void GetNodes(std::vector<CCompNodeConstPtr>& nodes);
+
+    //! number of registered nodes
+    size_t GetNumOfNodes(void);
+
+    //! get current generation
+    unsigned int GetGeneration(void);
+
+    //! get published snapshot of all nodes, it is never NULL
+    CClusterSnapshotPtr GetSnapshot(void);
+
+// section of private data -----------------------------------------------------
+private:
+    class CNodeShard {
+    public:
+        CSimpleMutex                        Mutex;
+        std::map<std::string,CCompNodePtr>  Nodes;
+    };
+
+    CNodeShard      Shards[NODE_REGISTRY_SHARDS];
+    CSimpleMutex    CountMutex;
+    size_t          NumOfNodes;
+    size_t          MaxNodes;
+    unsigned int    Generation;
+
+    CSimpleMutex        SnapshotMutex;      // serializes snapshot builders
+    CClusterSnapshotPtr Snapshot;           // accessed by atomic_load/store
+
+    // increase generation
+    void Changed(void);
+
+    // get shard for given node
+    CNodeShard& GetShard(const std::string& name);
+    static unsigned int GetShardIndex(const std::string& name);
+
+    // lock shard and record the wait time
+    static void LockShard(CNodeShard& shard);
+
+    // get a private copy of node for modification, shard must be locked
+    static CCompNodePtr CloneNode(CNodeShard& shard,const std::string& name);
+
+    // reserve a slot for new node, false if there are too many nodes
+    bool ReserveNode(void);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,514 @@
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <NodeStateStore.hpp>
+#include <ErrorSystem.hpp>
+#include <SmallString.hpp>
+#include <SmallTimeAndDate.hpp>
+#include <XMLElement.hpp>
+#include <StatPacket.hpp>
+#include <StatChecksum.hpp>
+#include <Metrics.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+#define STATE_MAGIC         "CSNS"
+#define STATE_VERSION       1
+#define STATE_HEADER_SIZE   24
+
+// node record without the datagram packet
+#define STATE_NODE_SIZE     (2 + 1 + 4 + 4 + 1 + 4 + 4)
+
+// modes
+#define STATE_POWERON       0x01
+#define STATE_STARTVNC      0x02
+
+//------------------------------------------------------------------------------
+
+static void PutU8(std::vector<unsigned char>& buffer,unsigned int value)
+{
+    buffer.push_back(value & 0xFF);
+}
+
+//------------------------------------------------------------------------------
+
+static void PutU16(std::vector<unsigned char>& buffer,unsigned int value)
+{
+    PutU8(buffer,value >> 8);
+    PutU8(buffer,value);
+}
+
+//------------------------------------------------------------------------------
+
+static void PutU32(std::vector<unsigned char>& buffer,unsigned int value)
+{
+    PutU16(buffer,value >> 16);
+    PutU16(buffer,value);
+}
+
+//------------------------------------------------------------------------------
+
+static void SetU32(std::vector<unsigned char>& buffer,size_t pos,unsigned int value)
+{
+    buffer[pos]   = (value >> 24) & 0xFF;
+    buffer[pos+1] = (value >> 16) & 0xFF;
+    buffer[pos+2] = (value >> 8) & 0xFF;
+    buffer[pos+3] = value & 0xFF;
+}
+
+//------------------------------------------------------------------------------
+
+static unsigned int GetU16(const unsigned char* p_data)
+{
+    return( (p_data[0] << 8) | p_data[1] );
+}
+
+//------------------------------------------------------------------------------
+
+static unsigned int GetU32(const unsigned char* p_data)
+{
+    return( ((unsigned int)p_data[0] << 24) | ((unsigned int)p_data[1] << 16) |
+            ((unsigned int)p_data[2] << 8) | (unsigned int)p_data[3] );
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CNodeStateStore::CNodeStateStore(void)
+{
+    Enabled             = true;
+    StateFile           = "/var/lib/cluster-stat/cluster-stat-server.state";
+    Interval            = 30;
+    MaxAge              = 900;
+    Nodes               = NULL;
+
+    NumOfSaves          = 0;
+    NumOfFailedSaves    = 0;
+    NumOfRestored       = 0;
+    LastSaveTime        = 0;
+    LastSaveSize        = 0;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CNodeStateStore::ProcessStateControl(CVerboseStr& vout,CXMLElement* p_config)
+{
+    vout << "#" << endl;
+    vout << "# === [state] ==================================================================" << endl;
+
+    if( p_config == NULL ){
+        vout << "# Node state store (enabled)                     = " << setw(6) << bool_to_str(Enabled) << "              (default)" << endl;
+        vout << "# State file (file)                              = " << StateFile << " (default)" << endl;
+        vout << "# Checkpoint interval (interval) [s]             = " << setw(6) << Interval << "              (default)" << endl;
+        vout << "# Max age of state file (maxage) [s]             = " << setw(6) << MaxAge << "              (default)" << endl;
+        return(true);
+    }
+
+    if( p_config->GetAttribute("enabled",Enabled) == true ) {
+        vout << "# Node state store (enabled)                     = " << setw(6) << bool_to_str(Enabled) << endl;
+    } else {
+        vout << "# Node state store (enabled)                     = " << setw(6) << bool_to_str(Enabled) << "              (default)" << endl;
+    }
+
+    if( p_config->GetAttribute("file",StateFile) == true ) {
+        vout << "# State file (file)                              = " << StateFile << endl;
+    } else {
+        vout << "# State file (file)                              = " << StateFile << " (default)" << endl;
+    }
+
+    if( p_config->GetAttribute("interval",Interval) == true ) {
+        vout << "# Checkpoint interval (interval) [s]             = " << setw(6) << Interval << endl;
+    } else {
+        vout << "# Checkpoint interval (interval) [s]             = " << setw(6) << Interval << "              (default)" << endl;
+    }
+
+    if( p_config->GetAttribute("maxage",MaxAge) == true ) {
+        vout << "# Max age of state file (maxage) [s]             = " << setw(6) << MaxAge << endl;
+    } else {
+        vout << "# Max age of state file (maxage) [s]             = " << setw(6) << MaxAge << "              (default)" << endl;
+    }
+
+    if( Interval <= 0 ){
+        ES_ERROR("interval must be greater than zero");
+        return(false);
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void CNodeStateStore::SetRegistry(CNodeRegistry* p_nodes)
+{
+    Nodes = p_nodes;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CNodeStateStore::Load(CVerboseStr& vout)
+{
+    if( (Enabled == false) || (Nodes == NULL) ) return(true);
+
+    // the thread is not running yet
+    if( CheckStateDir() == false ){
+        ES_ERROR("node state store is disabled");
+        Enabled = false;
+        return(false);
+    }
+
+    double start = CMetrics::GetTime();
+
+    int fd = open(StateFile,O_RDONLY|O_NOFOLLOW);
+    if( fd < 0 ){
+        if( errno != ENOENT ){
+            CSmallString error;
+            error << "unable to open state file '" << StateFile << "' (" << strerror(errno) << ")";
+            ES_WARNING(error);
+        }
+        return(false);
+    }
+
+    struct stat info;
+    if( (fstat(fd,&info) != 0) || (info.st_size < STATE_HEADER_SIZE) ){
+        close(fd);
+        CSmallString error;
+        error << "state file '" << StateFile << "' is truncated - ignoring it";
+        ES_WARNING(error);
+        return(false);
+    }
+
+    // the file must be written by the server itself
+    if( (S_ISREG(info.st_mode) == false) || (info.st_uid != geteuid()) || ((info.st_mode & (S_IWGRP|S_IWOTH)) != 0) ){
+        close(fd);
+        CSmallString error;
+        error << "state file '" << StateFile << "' is not owned by the server or it is writable by others - ignoring it";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    size_t len = info.st_size;
+    void* p_map = mmap(NULL,len,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if( p_map == MAP_FAILED ){
+        CSmallString error;
+        error << "unable to map state file '" << StateFile << "' (" << strerror(errno) << ")";
+        ES_WARNING(error);
+        return(false);
+    }
+
+    int  num_of_nodes = 0;
+    bool result = Restore(static_cast<const unsigned char*>(p_map),len,num_of_nodes);
+
+    munmap(p_map,len);
+
+    if( result == false ) return(false);
+
+    StatMutex.Lock();
+        NumOfRestored = num_of_nodes;
+    StatMutex.Unlock();
+
+    vout << "# Restored nodes from state file       = " << num_of_nodes << " (" << fixed << setprecision(3)
+         << (CMetrics::GetTime() - start) * 1000.0 << " ms)" << endl;
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CNodeStateStore::Restore(const unsigned char* p_data,size_t len,int& num_of_nodes)
+{
+    num_of_nodes = 0;
+
+    // header
+    if( (memcmp(p_data,STATE_MAGIC,4) != 0) || (GetU32(p_data+4) != STATE_VERSION) ){
+        CSmallString error;
+        error << "state file '" << StateFile << "' has unsupported format - ignoring it";
+        ES_WARNING(error);
+        return(false);
+    }
+
+    int             created = GetU32(p_data+8);
+    unsigned int    count   = GetU32(p_data+12);
+    size_t          body    = GetU32(p_data+16);
+
+    if( (body != len - STATE_HEADER_SIZE) ||
+        (StatCRC32C(0,p_data+STATE_HEADER_SIZE,body) != GetU32(p_data+20)) ){
+        CSmallString error;
+        error << "state file '" << StateFile << "' is corrupted - ignoring it";
+        ES_WARNING(error);
+        return(false);
+    }
+
+    // stale data - everything would be shown down anyway
+    CSmallTimeAndDate time;
+    time.GetActualTimeAndDate();
+    int now = time.GetSecondsFromBeginning();
+    if( (MaxAge > 0) && (now - created > MaxAge) ){
+        CSmallString warning;
+        warning << "state file '" << StateFile << "' is too old (" << now - created << " s) - ignoring it";
+        ES_WARNING(warning);
+        return(false);
+    }
+
+    // nodes
+    const unsigned char* p_pos = p_data + STATE_HEADER_SIZE;
+    const unsigned char* p_end = p_data + len;
+
+    for(unsigned int i=0; i < count; i++){
+        if( p_end - p_pos < STATE_NODE_SIZE ) break;
+        size_t plen = GetU16(p_pos);
+        if( (size_t)(p_end - p_pos) < STATE_NODE_SIZE + plen ) break;
+
+        CCompNode node;
+        if( node.Basic.Deserialize(reinterpret_cast<const char*>(p_pos+2),plen) == false ){
+            ES_WARNING("unable to decode node in state file - skipping it");
+            p_pos += STATE_NODE_SIZE + plen;
+            continue;
+        }
+        p_pos += 2 + plen;
+
+        unsigned int modes  = p_pos[0];
+        node.InPowerOnMode  = (modes & STATE_POWERON) != 0;
+        node.PowerOnTime    = GetU32(p_pos+1);
+        node.InStartVNCMode = (modes & STATE_STARTVNC) != 0;
+        node.StartVNCTime   = GetU32(p_pos+5);
+        node.PowerStat      = EPS_UNKNOWN;
+        if( p_pos[9] <= EPS_UNKNOWN ) node.PowerStat = static_cast<EPowerStat>(p_pos[9]);
+        node.NCPUs          = GetU32(p_pos+10);
+        node.NGPUs          = GetU32(p_pos+14);
+        p_pos += STATE_NODE_SIZE - 2;
+
+        if( Nodes->RestoreNode(node) == true ) num_of_nodes++;
+    }
+
+    if( p_pos != p_end ){
+        CSmallString warning;
+        warning << "state file '" << StateFile << "' has inconsistent node records";
+        ES_WARNING(warning);
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+std::string CNodeStateStore::GetStateDir(void)
+{
+    std::string name((const char*)StateFile);
+    size_t pos = name.rfind('/');
+    if( pos == std::string::npos ) return(".");
+    if( pos == 0 ) return("/");
+    return(name.substr(0,pos));
+}
+
+//------------------------------------------------------------------------------
+
+bool CNodeStateStore::CheckStateDir(void)
+{
+    std::string dir = GetStateDir();
+
+    // other users must not be able to plant or replace the state file
+    struct stat info;
+    if( lstat(dir.c_str(),&info) != 0 ){
+        CSmallString error;
+        error << "unable to access state directory '" << dir.c_str() << "' (" << strerror(errno) << ")";
+        ES_ERROR(error);
+        return(false);
+    }
+    if( (S_ISDIR(info.st_mode) == false) || (info.st_uid != geteuid()) || ((info.st_mode & (S_IWGRP|S_IWOTH)) != 0) ){
+        CSmallString error;
+        error << "state directory '" << dir.c_str() << "' must be owned by the server and not writable by others";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CNodeStateStore::Save(void)
+{
+    if( Nodes == NULL ) return(false);
+
+    double start = CMetrics::GetTime();
+
+    std::vector<CCompNodeConstPtr> nodes;
+    Nodes->GetNodes(nodes);
+
+    CSmallTimeAndDate time;
+    time.GetActualTimeAndDate();
+
+    std::vector<unsigned char> buffer;
+    buffer.reserve(STATE_HEADER_SIZE + nodes.size()*512);
+
+    // header - length and checksum are set later
+    buffer.insert(buffer.end(),STATE_MAGIC,STATE_MAGIC+4);
+    PutU32(buffer,STATE_VERSION);
+    PutU32(buffer,time.GetSecondsFromBeginning());
+    PutU32(buffer,0);
+    PutU32(buffer,0);
+    PutU32(buffer,0);
+
+    char            packet[STAT_PACKET_MAX_SIZE];
+    unsigned int    count = 0;
+
+    for(size_t i=0; i < nodes.size(); i++){
+        const CCompNode& node = *nodes[i];
+        // nodes without any data are recreated from config
+        if( (node.GetTimeStamp() == 0) && (node.InPowerOnMode == false) && (node.InStartVNCMode == false) ) continue;
+
+        // include the last heartbeat
+        CStatDatagram dtg(node.Basic);
+        dtg.TimeStamp = node.GetTimeStamp();
+        size_t plen = dtg.Serialize(packet,sizeof(packet));
+        if( plen == 0 ) continue;
+
+        PutU16(buffer,plen);
+        buffer.insert(buffer.end(),packet,packet+plen);
+
+        unsigned int modes = 0;
+        if( node.InPowerOnMode ) modes |= STATE_POWERON;
+        if( node.InStartVNCMode ) modes |= STATE_STARTVNC;
+        PutU8(buffer,modes);
+        PutU32(buffer,node.PowerOnTime);
+        PutU32(buffer,node.StartVNCTime);
+        PutU8(buffer,node.PowerStat);
+        PutU32(buffer,node.NCPUs);
+        PutU32(buffer,node.NGPUs);
+        count++;
+    }
+
+    size_t body = buffer.size() - STATE_HEADER_SIZE;
+    SetU32(buffer,12,count);
+    SetU32(buffer,16,body);
+    SetU32(buffer,20,StatCRC32C(0,&buffer[STATE_HEADER_SIZE],body));
+
+    // write a new temporary file (mode 0600) and replace the old one atomically
+    std::string tmp_name = std::string((const char*)StateFile) + ".XXXXXX";
+
+    bool result = false;
+    int fd = mkstemp(&tmp_name[0]);
+    if( fd >= 0 ){
+        size_t pos = 0;
+        while( pos < buffer.size() ){
+            ssize_t ret = write(fd,&buffer[pos],buffer.size()-pos);
+            if( ret < 0 ){
+                if( errno == EINTR ) continue;
+                break;
+            }
+            pos += ret;
+        }
+        result = (pos == buffer.size()) && (fsync(fd) == 0);
+        if( close(fd) != 0 ) result = false;
+        if( result ) result = rename(tmp_name.c_str(),StateFile) == 0;
+        if( result == false ) unlink(tmp_name.c_str());
+    }
+
+    // make the rename durable
+    if( result ){
+        int dfd = open(GetStateDir().c_str(),O_RDONLY|O_DIRECTORY);
+        if( dfd >= 0 ){
+            fsync(dfd);
+            close(dfd);
+        }
+    }
+
+    if( result == false ){
+        CSmallString error;
+        error << "unable to save state file '" << StateFile << "' (" << strerror(errno) << ")";
+        ES_ERROR(error);
+    }
+
+    StatMutex.Lock();
+        if( result ){
+            NumOfSaves++;
+            LastSaveTime = CMetrics::GetTime() - start;
+            LastSaveSize = buffer.size();
+        } else {
+            NumOfFailedSaves++;
+        }
+    StatMutex.Unlock();
+
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+void CNodeStateStore::PrintStatistics(CVerboseStr& vout)
+{
+    if( Enabled == false ) return;
+
+    StatMutex.Lock();
+        vout << "# Number of restored nodes             = " << NumOfRestored << endl;
+        vout << "# Number of state checkpoints          = " << NumOfSaves << endl;
+        vout << "# Number of failed state checkpoints   = " << NumOfFailedSaves << endl;
+        if( NumOfSaves > 0 ){
+        vout << "# Last checkpoint time [ms]            = " << fixed << setprecision(3) << LastSaveTime * 1000.0 << endl;
+        vout << "# Last checkpoint size [bytes]         = " << LastSaveSize << endl;
+        }
+    StatMutex.Unlock();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CNodeStateStore::ExecuteThread(void)
+{
+    if( Enabled == false ) return;
+
+    int elapsed = 0;
+    while( ! ThreadTerminated ) {
+        usleep(1000000); // sleep for 1 s
+        elapsed++;
+        if( elapsed < Interval ) continue;
+        Save();
+        elapsed = 0;
+    }
+
+    // final checkpoint
+    Save();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,109 @@
+#ifndef NodeStateStoreH
+#define NodeStateStoreH
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SmartThread.hpp>
+#include <SimpleMutex.hpp>
+#include <VerboseStr.hpp>
+#include <FileName.hpp>
+#include <NodeRegistry.hpp>
+#include <string>
+
+//------------------------------------------------------------------------------
+
+class CXMLElement;
+
+//------------------------------------------------------------------------------
+
+//! persistent node state
+/*! \ingroup eserver
+
+  [state]
+  enabled           (on/off) - determine if the node state is saved and restored
+  file              (path)   - state file, its directory must be owned by
+                               the server and not writable by others
+  interval          (int)    - time in seconds between checkpoints
+  maxage            (int)    - older state files are not restored
+
+  the registry is periodically written to a temporary file, which is renamed
+  over the state file; the file is mapped to memory and restored on startup,
+  nodes keep their original timestamps thus they are shown down when
+  their data are too old
+
+  file layout (integers in network byte order):
+    header: magic "CSNS", version, creation time, number of nodes,
+            body length, CRC32C of body (all u32)
+    node:   datagram packet length (u16), datagram packet (StatPacket.hpp),
+            modes (u8), power on time (u32), start VNC time (u32),
+            power state (u8), ncpus (u32), ngpus (u32)
+*/
+class CNodeStateStore : public CSmartThread {
+public:
+// constructor -----------------------------------------------------------------
+    CNodeStateStore(void);
+
+    //! read state setup
+    bool ProcessStateControl(CVerboseStr& vout,CXMLElement* p_config);
+
+    //! set registry
+    void SetRegistry(CNodeRegistry* p_nodes);
+
+// executive methods -----------------------------------------------------------
+    //! restore registry from the state file
+    bool Load(CVerboseStr& vout);
+
+    //! write registry to the state file
+    bool Save(void);
+
+    //! print statistics
+    void PrintStatistics(CVerboseStr& vout);
+
+// section of private data -----------------------------------------------------
+private:
+    bool            Enabled;
+    CFileName       StateFile;
+    int             Interval;
+    int             MaxAge;
+    CNodeRegistry*  Nodes;
+
+    CSimpleMutex    StatMutex;
+    int             NumOfSaves;
+    int             NumOfFailedSaves;
+    int             NumOfRestored;
+    double          LastSaveTime;
+    size_t          LastSaveSize;
+
+    // main loop
+    virtual void ExecuteThread(void);
+
+    // decode state file
+    bool Restore(const unsigned char* p_data,size_t len,int& num_of_nodes);
+
+    // directory with the state file
+    std::string GetStateDir(void);
+
+    // check that the directory is private to the server
+    bool CheckStateDir(void);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
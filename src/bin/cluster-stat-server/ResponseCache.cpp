@@ -0,0 +1,124 @@
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <ResponseCache.hpp>
+#include <StatChecksum.hpp>
+#include <stdio.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CResponseBody::CResponseBody(const std::string& data,const char* p_variant)
+{
+    Data = data;
+
+    unsigned int crc = StatCRC32C(0,Data.data(),Data.size());
+    if( p_variant != NULL ){
+        crc = StatCRC32C(crc,p_variant,strlen(p_variant));
+    }
+
+    char buffer[32];
+    snprintf(buffer,sizeof(buffer),"\"%08x-%zx\"",crc,Data.size());
+    ETag = buffer;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CResponseCache::CCachedBody::CCachedBody(void)
+{
+    Generation      = 0;
+    CreationTime    = 0;
+}
+
+//------------------------------------------------------------------------------
+
+CResponseCache::CResponseCache(void)
+{
+    Hits    = 0;
+    Misses  = 0;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CResponseBodyPtr CResponseCache::Get(const std::string& action,const CClusterSnapshotPtr& snapshot)
+{
+    CResponseBodyPtr body;
+
+    CacheMutex.Lock();
+        std::map<std::string,CCachedBody>::iterator it = Cache.find(action);
+        if( (it != Cache.end()) && (it->second.Generation == snapshot->Generation) &&
+            (it->second.CreationTime == snapshot->CreationTime) ){
+            body = it->second.Body;
+            Hits++;
+        } else {
+            Misses++;
+        }
+    CacheMutex.Unlock();
+
+    return(body);
+}
+
+//------------------------------------------------------------------------------
+
+void CResponseCache::Set(const std::string& action,const CClusterSnapshotPtr& snapshot,const CResponseBodyPtr& body)
+{
+    CacheMutex.Lock();
+        CCachedBody& entry = Cache[action];
+        entry.Generation    = snapshot->Generation;
+        entry.CreationTime  = snapshot->CreationTime;
+        entry.Body          = body;
+    CacheMutex.Unlock();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+unsigned int CResponseCache::GetHits(void)
+{
+    CacheMutex.Lock();
+        unsigned int hits = Hits;
+    CacheMutex.Unlock();
+    return(hits);
+}
+
+//------------------------------------------------------------------------------
+
+unsigned int CResponseCache::GetMisses(void)
+{
+    CacheMutex.Lock();
+        unsigned int misses = Misses;
+    CacheMutex.Unlock();
+    return(misses);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,91 @@
+#ifndef ResponseCacheH
+#define ResponseCacheH
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <NodeRegistry.hpp>
+#include <SimpleMutex.hpp>
+#include <map>
+#include <string>
+#include <boost/shared_ptr.hpp>
+
+//------------------------------------------------------------------------------
+
+//! rendered response body
+/*!
+  entity tag is CRC32C of the body and of an optional variant (e.g. user name),
+  it is thus identical for identical responses regardless of the snapshot
+*/
+
+class CResponseBody {
+public:
+    CResponseBody(const std::string& data,const char* p_variant=NULL);
+
+public:
+    std::string     Data;
+    std::string     ETag;       // including quotes
+};
+
+typedef boost::shared_ptr<const CResponseBody>  CResponseBodyPtr;
+
+//------------------------------------------------------------------------------
+
+//! cache of rendered responses
+/*!
+  bodies are rendered from a cluster snapshot, they are thus valid as long as
+  the same snapshot is published (its generation and creation time match)
+*/
+
+class CResponseCache {
+public:
+// constructor -----------------------------------------------------------------
+    CResponseCache(void);
+
+// executive methods -----------------------------------------------------------
+    //! get cached body, NULL if it is not available for given snapshot
+    CResponseBodyPtr Get(const std::string& action,const CClusterSnapshotPtr& snapshot);
+
+    //! store rendered body
+    void Set(const std::string& action,const CClusterSnapshotPtr& snapshot,const CResponseBodyPtr& body);
+
+// statistics ------------------------------------------------------------------
+    unsigned int GetHits(void);
+    unsigned int GetMisses(void);
+
+// section of private data -----------------------------------------------------
+private:
+    class CCachedBody {
+    public:
+        CCachedBody(void);
+    public:
+        unsigned int        Generation;
+        int                 CreationTime;
+        CResponseBodyPtr    Body;
+    };
+
+    CSimpleMutex                        CacheMutex;
+    std::map<std::string,CCachedBody>   Cache;
+    unsigned int                        Hits;
+    unsigned int                        Misses;
+};
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,555 @@
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SeatNotifier.hpp>
+#include <ErrorSystem.hpp>
+#include <SmallTimeAndDate.hpp>
+#include <XMLElement.hpp>
+#include <unistd.h>
+#include <iomanip>
+#include <sstream>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CSeatNotifier::CSeatNotifier(void)
+{
+    Enabled             = true;
+    MaxSubscribers      = 64;
+    Heartbeat           = 15;
+    MaxBacklog          = 256;
+    Nodes               = NULL;
+    NumOfSubscribers    = 0;
+    NumOfRejected       = 0;
+    NumOfDropped        = 0;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CSeatNotifier::ProcessWatchControl(CVerboseStr& vout,CXMLElement* p_config)
+{
+    vout << "#" << endl;
+    vout << "# === [watch] ==================================================================" << endl;
+
+    if( p_config == NULL ){
+        vout << "# Watch action (enabled)                         = " << setw(6) << bool_to_str(Enabled) << "              (default)" << endl;
+        vout << "# Max subscribers (maxsubscribers)               = " << setw(6) << MaxSubscribers << "              (default)" << endl;
+        vout << "# Heartbeat (heartbeat) [s]                      = " << setw(6) << Heartbeat << "              (default)" << endl;
+        vout << "# Max subscriber backlog (maxbacklog) [kB]       = " << setw(6) << MaxBacklog << "              (default)" << endl;
+        return(true);
+    }
+
+    if( p_config->GetAttribute("enabled",Enabled) == true ) {
+        vout << "# Watch action (enabled)                         = " << setw(6) << bool_to_str(Enabled) << endl;
+    } else {
+        vout << "# Watch action (enabled)                         = " << setw(6) << bool_to_str(Enabled) << "              (default)" << endl;
+    }
+
+    if( p_config->GetAttribute("maxsubscribers",MaxSubscribers) == true ) {
+        vout << "# Max subscribers (maxsubscribers)               = " << setw(6) << MaxSubscribers << endl;
+    } else {
+        vout << "# Max subscribers (maxsubscribers)               = " << setw(6) << MaxSubscribers << "              (default)" << endl;
+    }
+
+    if( p_config->GetAttribute("heartbeat",Heartbeat) == true ) {
+        vout << "# Heartbeat (heartbeat) [s]                      = " << setw(6) << Heartbeat << endl;
+    } else {
+        vout << "# Heartbeat (heartbeat) [s]                      = " << setw(6) << Heartbeat << "              (default)" << endl;
+    }
+
+    if( p_config->GetAttribute("maxbacklog",MaxBacklog) == true ) {
+        vout << "# Max subscriber backlog (maxbacklog) [kB]       = " << setw(6) << MaxBacklog << endl;
+    } else {
+        vout << "# Max subscriber backlog (maxbacklog) [kB]       = " << setw(6) << MaxBacklog << "              (default)" << endl;
+    }
+
+    if( Heartbeat <= 0 ){
+        ES_ERROR("heartbeat must be greater than zero");
+        return(false);
+    }
+
+    if( MaxBacklog <= 0 ){
+        ES_ERROR("maxbacklog must be greater than zero");
+        return(false);
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void CSeatNotifier::SetRegistry(CNodeRegistry* p_nodes)
+{
+    Nodes = p_nodes;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CSeatNotifier::Subscribe(CFCGIRequestPtr& p_request)
+{
+    if( Enabled == false ) return(false);
+
+    bool result = false;
+    SubscribersMutex.Lock();
+        if( NumOfSubscribers < MaxSubscribers ){
+            NewSubscribers.push_back(p_request);
+            NumOfSubscribers++;
+            result = true;
+        } else {
+            NumOfRejected++;
+        }
+    SubscribersMutex.Unlock();
+
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+unsigned int CSeatNotifier::GetNumOfRejected(void)
+{
+    SubscribersMutex.Lock();
+        unsigned int rejected = NumOfRejected;
+    SubscribersMutex.Unlock();
+    return(rejected);
+}
+
+//------------------------------------------------------------------------------
+
+unsigned int CSeatNotifier::GetNumOfDropped(void)
+{
+    SubscribersMutex.Lock();
+        unsigned int dropped = NumOfDropped;
+    SubscribersMutex.Unlock();
+    return(dropped);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CSeatNotifier::WriteSeat(std::ostream& str,const CCompNode& node,int now)
+{
+    const CStatDatagram& dtg = node.Basic;
+
+    // check node status
+    const char* status = "up";
+    // check timestamp from user stat file or heartbeat
+    if( (now - node.GetTimeStamp() > 180) || dtg.IsDown() ){  // skew of 180 seconds
+        status = "down";
+    }
+
+    str << status << ';' << dtg.GetNodeName(); // node status and name
+
+    str << ';' << dtg.NumOfLocalUsers << ',' << dtg.NumOfRemoteUsers << ',' << dtg.NumOfVNCRemoteUsers;
+
+    if( (dtg.NumOfLocalUsers > 0) || (dtg.NumOfRemoteUsers > 0) ){
+        str << ';';
+    }
+    bool delimit = false;
+    for(int i=0; i < dtg.NumOfLocalUsers; i++){
+        if( delimit ) str << '|';
+        str << dtg.GetLocalUserName(i) << " (" << dtg.GetLocalLoginName(i);
+        if( dtg.GetLocalLoginType(i) == 'W' ){
+            str << ") [Wayland]";
+        } else {
+            str << ") [X11]";
+        }
+        delimit = true;
+    }
+    for(int i=0; i < dtg.NumOfRemoteUsers; i++){
+        if( delimit ) str << '|';
+        str << dtg.GetRemoteUserName(i) << " (" << dtg.GetRemoteLoginName(i);
+        if( dtg.GetRemoteLoginType(i) == 'R' ){
+            str << ") [RDSK]";
+        } else if( dtg.GetRemoteLoginType(i) == 'V' ){
+            str << ") [VNC]";
+        } else {
+            str << ") [ssh]";
+        }
+        delimit = true;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CSeatNotifier::WritePower(std::ostream& str,const CCompNode& node)
+{
+    str << node.Name << ';';
+
+    switch(node.PowerStat){
+        case EPS_DOWN:
+            str << "down";
+            break;
+        case EPS_UP:
+            str << "up";
+            break;
+        case EPS_MAINTANANCE:
+            str << "maintenance";
+            break;
+        case EPS_UNKNOWN:
+            str << "unknown";
+            break;
+    }
+
+    if( node.InPowerOnMode ){
+        str << ";poweron";
+    } else {
+        str << ";-";
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CSeatNotifier::ExecuteThread(void)
+{
+    if( (Enabled == false) || (Nodes == NULL) ) return;
+
+    CSmallTimeAndDate time;
+    time.GetActualTimeAndDate();
+    int last_heartbeat = time.GetSecondsFromBeginning();
+
+    while( ! ThreadTerminated ) {
+
+        // seat changes - the snapshot is rebuilt when the registry changes
+        CClusterSnapshotPtr snapshot = Nodes->GetSnapshot();
+        if( snapshot != LastSnapshot ){
+            string event = UpdateSeats(snapshot);
+            if( event.empty() == false ) Broadcast(event);
+            LastSnapshot = snapshot;
+        }
+
+        // new subscribers get the whole state
+        std::vector<CFCGIRequestPtr> subscribers;
+        SubscribersMutex.Lock();
+            subscribers.swap(NewSubscribers);
+        SubscribersMutex.Unlock();
+
+        if( subscribers.empty() == false ){
+            string event;
+            event += "Content-type: text/event-stream\r\n";
+            event += "Cache-Control: no-cache\r\n";
+            event += "\r\n";
+            event += "retry: 5000\n";
+            event += GetAllSeats();
+            for(size_t i=0; i < subscribers.size(); i++){
+                CSeatSubscriberPtr p_sub(new CSeatSubscriber(subscribers[i]));
+                p_sub->Send(event,MaxBacklog*1024);
+                if( p_sub->StartThread() == false ){
+                    ES_ERROR("unable to start watch stream writer");
+                    subscribers[i]->FinishRequest();
+                    SubscribersMutex.Lock();
+                        NumOfSubscribers--;
+                    SubscribersMutex.Unlock();
+                    continue;
+                }
+                Subscribers.push_back(p_sub);
+            }
+        }
+
+        // keep the streams alive and detect disconnected clients
+        time.GetActualTimeAndDate();
+        int now = time.GetSecondsFromBeginning();
+        if( now - last_heartbeat >= Heartbeat ){
+            Broadcast(": heartbeat\n\n");
+            last_heartbeat = now;
+        }
+
+        ReapSubscribers(false);
+
+        usleep(250000); // sleep for 250 ms
+    }
+
+    for(size_t i=0; i < Subscribers.size(); i++){
+        Subscribers[i]->Stop();
+        Closing.push_back(Subscribers[i]);
+    }
+    Subscribers.clear();
+    ReapSubscribers(true);
+
+    std::vector<CFCGIRequestPtr> subscribers;
+    SubscribersMutex.Lock();
+        subscribers.swap(NewSubscribers);
+        NumOfSubscribers -= subscribers.size();
+    SubscribersMutex.Unlock();
+    for(size_t i=0; i < subscribers.size(); i++){
+        subscribers[i]->FinishRequest();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+std::string CSeatNotifier::UpdateSeats(const CClusterSnapshotPtr& snapshot)
+{
+    CSmallTimeAndDate time;
+    time.GetActualTimeAndDate();
+    int now = time.GetSecondsFromBeginning();
+
+    stringstream event;
+    event << "id: " << snapshot->Generation << "\n";
+
+    stringstream power;
+    power << "event: power\n";
+    power << "id: " << snapshot->Generation << "\n";
+
+    bool changed = false;
+    bool power_changed = false;
+
+    std::vector<CCompNodeConstPtr>::const_iterator it = snapshot->Nodes.begin();
+    std::vector<CCompNodeConstPtr>::const_iterator ie = snapshot->Nodes.end();
+
+    while( it != ie ){
+        stringstream str;
+        WriteSeat(str,**it,now);
+        string line = str.str();
+        string& last = Seats[(*it)->Name];
+        if( last != line ){
+            event << "data: " << line << "\n";
+            last = line;
+            changed = true;
+        }
+
+        // batch system and power on changes do not alter the seat line
+        stringstream pstr;
+        WritePower(pstr,**it);
+        string pline = pstr.str();
+        string& plast = Powers[(*it)->Name];
+        if( plast != pline ){
+            power << "data: " << pline << "\n";
+            plast = pline;
+            power_changed = true;
+        }
+        it++;
+    }
+
+    string events;
+    if( changed ){
+        event << "\n";
+        events += event.str();
+    }
+    if( power_changed ){
+        power << "\n";
+        events += power.str();
+    }
+
+    return(events);
+}
+
+//------------------------------------------------------------------------------
+
+std::string CSeatNotifier::GetAllSeats(void)
+{
+    stringstream event;
+    event << "event: seats\n";
+    if( LastSnapshot ){
+        event << "id: " << LastSnapshot->Generation << "\n";
+    }
+
+    std::map<std::string,std::string>::const_iterator it = Seats.begin();
+    std::map<std::string,std::string>::const_iterator ie = Seats.end();
+
+    while( it != ie ){
+        event << "data: " << it->second << "\n";
+        it++;
+    }
+    event << "\n";
+
+    event << "event: power\n";
+    if( LastSnapshot ){
+        event << "id: " << LastSnapshot->Generation << "\n";
+    }
+
+    it = Powers.begin();
+    ie = Powers.end();
+
+    while( it != ie ){
+        event << "data: " << it->second << "\n";
+        it++;
+    }
+    event << "\n";
+
+    return(event.str());
+}
+
+//------------------------------------------------------------------------------
+
+void CSeatNotifier::Broadcast(const std::string& data)
+{
+    std::vector<CSeatSubscriberPtr>::iterator it = Subscribers.begin();
+    while( it != Subscribers.end() ){
+        CSeatSubscriberPtr p_sub = *it;
+        if( p_sub->Send(data,MaxBacklog*1024) == false ){
+            // disconnected or too slow - the writer finishes the request
+            if( p_sub->HasFailed() == false ){
+                SubscribersMutex.Lock();
+                    NumOfDropped++;
+                SubscribersMutex.Unlock();
+            }
+            p_sub->Stop();
+            Closing.push_back(p_sub);
+            it = Subscribers.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CSeatNotifier::ReapSubscribers(bool wait)
+{
+    // stalled writers still count as subscribers until their requests are finished
+    std::vector<CSeatSubscriberPtr>::iterator it = Closing.begin();
+    while( it != Closing.end() ){
+        CSeatSubscriberPtr p_sub = *it;
+        if( wait || p_sub->IsFinished() ){
+            p_sub->WaitForThread();
+            it = Closing.erase(it);
+            SubscribersMutex.Lock();
+                NumOfSubscribers--;
+            SubscribersMutex.Unlock();
+        } else {
+            it++;
+        }
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CSeatSubscriber::CSeatSubscriber(const CFCGIRequestPtr& p_request)
+{
+    Request     = p_request;
+    Stopped     = false;
+    Failed      = false;
+    Finished    = false;
+
+    pthread_mutex_init(&BacklogMutex,NULL);
+    pthread_cond_init(&BacklogCond,NULL);
+}
+
+//------------------------------------------------------------------------------
+
+CSeatSubscriber::~CSeatSubscriber(void)
+{
+    pthread_cond_destroy(&BacklogCond);
+    pthread_mutex_destroy(&BacklogMutex);
+}
+
+//------------------------------------------------------------------------------
+
+bool CSeatSubscriber::Send(const std::string& data,size_t max_backlog)
+{
+    bool result = true;
+
+    pthread_mutex_lock(&BacklogMutex);
+        if( Failed || Stopped ){
+            result = false;
+        } else if( (Backlog.empty() == false) && (Backlog.size() + data.size() > max_backlog) ){
+            // the client does not read its stream
+            result = false;
+        } else {
+            Backlog += data;
+            pthread_cond_signal(&BacklogCond);
+        }
+    pthread_mutex_unlock(&BacklogMutex);
+
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+void CSeatSubscriber::Stop(void)
+{
+    pthread_mutex_lock(&BacklogMutex);
+        Stopped = true;
+        Backlog.clear();
+        pthread_cond_broadcast(&BacklogCond);
+    pthread_mutex_unlock(&BacklogMutex);
+}
+
+//------------------------------------------------------------------------------
+
+bool CSeatSubscriber::HasFailed(void)
+{
+    pthread_mutex_lock(&BacklogMutex);
+        bool failed = Failed;
+    pthread_mutex_unlock(&BacklogMutex);
+    return(failed);
+}
+
+//------------------------------------------------------------------------------
+
+bool CSeatSubscriber::IsFinished(void)
+{
+    pthread_mutex_lock(&BacklogMutex);
+        bool finished = Finished;
+    pthread_mutex_unlock(&BacklogMutex);
+    return(finished);
+}
+
+//------------------------------------------------------------------------------
+
+void CSeatSubscriber::ExecuteThread(void)
+{
+    for(;;) {
+        string data;
+
+        pthread_mutex_lock(&BacklogMutex);
+            while( (Stopped == false) && Backlog.empty() ){
+                pthread_cond_wait(&BacklogCond,&BacklogMutex);
+            }
+            if( Stopped ){
+                pthread_mutex_unlock(&BacklogMutex);
+                break;
+            }
+            data.swap(Backlog);
+        pthread_mutex_unlock(&BacklogMutex);
+
+        // this can block until the client reads data or the connection is closed
+        if( (Request->OutStream.PutStr(data) == false) || (Request->OutStream.Flush() == false) ){
+            pthread_mutex_lock(&BacklogMutex);
+                Failed = true;
+            pthread_mutex_unlock(&BacklogMutex);
+            break;
+        }
+    }
+
+    Request->FinishRequest();
+
+    pthread_mutex_lock(&BacklogMutex);
+        Finished = true;
+    pthread_mutex_unlock(&BacklogMutex);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
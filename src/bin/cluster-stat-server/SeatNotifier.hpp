@@ -0,0 +1,167 @@
+#ifndef SeatNotifierH
+#define SeatNotifierH
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SmartThread.hpp>
+#include <SimpleMutex.hpp>
+#include <VerboseStr.hpp>
+#include <NodeRegistry.hpp>
+#include <FCGIRequest.hpp>
+#include <boost/shared_ptr.hpp>
+#include <ostream>
+#include <vector>
+#include <map>
+#include <string>
+#include <pthread.h>
+
+//------------------------------------------------------------------------------
+
+class CXMLElement;
+
+typedef boost::shared_ptr<CFCGIRequest>    CFCGIRequestPtr;
+
+//------------------------------------------------------------------------------
+
+//! one watch stream - data are written by its own thread
+/*!
+  the notifier only appends data to the backlog, thus a stalled client
+  cannot block other subscribers, the request is finished by the writer thread
+*/
+class CSeatSubscriber : public CSmartThread {
+public:
+// constructor -----------------------------------------------------------------
+    CSeatSubscriber(const CFCGIRequestPtr& p_request);
+    ~CSeatSubscriber(void);
+
+// executive methods -----------------------------------------------------------
+    //! append data to the backlog, false if the stream failed or the backlog limit is exceeded
+    bool Send(const std::string& data,size_t max_backlog);
+
+    //! stop writing, unsent data are discarded
+    void Stop(void);
+
+    //! was the stream closed by the client?
+    bool HasFailed(void);
+
+    //! has the writer thread finished the request?
+    bool IsFinished(void);
+
+// section of private data -----------------------------------------------------
+private:
+    CFCGIRequestPtr     Request;
+
+    pthread_mutex_t     BacklogMutex;
+    pthread_cond_t      BacklogCond;    // signalled when data are added or the writer is stopped
+    std::string         Backlog;        // data not yet passed to the stream
+    bool                Stopped;
+    bool                Failed;
+    bool                Finished;
+
+    // main loop
+    virtual void ExecuteThread(void);
+};
+
+typedef boost::shared_ptr<CSeatSubscriber>  CSeatSubscriberPtr;
+
+//------------------------------------------------------------------------------
+
+//! push seat changes to subscribed clients (Server-Sent Events)
+/*! \ingroup eserver
+
+  [watch]
+  enabled           (on/off) - determine if the watch action is available
+  maxsubscribers    (int)    - max number of concurrently opened streams
+  heartbeat         (int)    - time in seconds between keep-alive comments
+  maxbacklog        (int)    - max size of unsent data per subscriber in kB
+
+  subscribed requests are kept open and served only by the notifier thread,
+  the first event contains all seats, next events contain only changed seats,
+  lines have the same format as the allseats action,
+  subscribers that do not read their stream are dropped when their backlog exceeds maxbacklog
+
+  power changes are sent in separate events (event: power) with lines
+  name;batch state (up/down/maintenance/unknown);poweron or -
+*/
+class CSeatNotifier : public CSmartThread {
+public:
+// constructor -----------------------------------------------------------------
+    CSeatNotifier(void);
+
+    //! read notifier setup
+    bool ProcessWatchControl(CVerboseStr& vout,CXMLElement* p_config);
+
+    //! set source of node states
+    void SetRegistry(CNodeRegistry* p_nodes);
+
+// executive methods -----------------------------------------------------------
+    //! take over the request, false if the limit of subscribers is reached
+    bool Subscribe(CFCGIRequestPtr& p_request);
+
+    //! write one seat line in the allseats format (without a new line)
+    static void WriteSeat(std::ostream& str,const CCompNode& node,int now);
+
+    //! write one power line (without a new line)
+    static void WritePower(std::ostream& str,const CCompNode& node);
+
+// statistics ------------------------------------------------------------------
+    unsigned int GetNumOfRejected(void);
+    unsigned int GetNumOfDropped(void);
+
+// section of private data -----------------------------------------------------
+private:
+    bool                                Enabled;
+    unsigned int                        MaxSubscribers;
+    int                                 Heartbeat;      // in seconds
+    int                                 MaxBacklog;     // in kB
+    CNodeRegistry*                      Nodes;
+
+    CSimpleMutex                        SubscribersMutex;
+    std::vector<CFCGIRequestPtr>        NewSubscribers;
+    unsigned int                        NumOfSubscribers;
+    unsigned int                        NumOfRejected;
+    unsigned int                        NumOfDropped;   // stalled subscribers
+
+    // accessed only by the notifier thread
+    std::vector<CSeatSubscriberPtr>     Subscribers;
+    std::vector<CSeatSubscriberPtr>     Closing;        // stopped, waiting for their writers
+    CClusterSnapshotPtr                 LastSnapshot;
+    std::map<std::string,std::string>   Seats;          // last sent seat lines
+    std::map<std::string,std::string>   Powers;         // last sent power lines
+
+    // main loop
+    virtual void ExecuteThread(void);
+
+    // update seat and power lines, return events with changed seats and power states
+    std::string UpdateSeats(const CClusterSnapshotPtr& snapshot);
+
+    // event with all seats and power states
+    std::string GetAllSeats(void);
+
+    // queue data for all subscribers, drop those that are disconnected or stalled
+    void Broadcast(const std::string& data);
+
+    // release subscribers whose writers have finished, wait for all of them if requested
+    void ReapSubscribers(bool wait);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
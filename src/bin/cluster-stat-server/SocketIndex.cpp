@@ -0,0 +1,114 @@
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SocketIndex.hpp>
+#include <ErrorSystem.hpp>
+#include <SmallTimeAndDate.hpp>
+#include <stdio.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CSocketIndex::CSocketIndex(void)
+{
+    CreationTime = 0;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CSocketIndex::IsBound(const CSmallString& path)
+{
+    if( path == NULL ) return(false);
+    CPathSetPtr paths = GetPaths();
+    return( paths->count(string(path)) > 0 );
+}
+
+//------------------------------------------------------------------------------
+
+CSocketIndex::CPathSetPtr CSocketIndex::GetPaths(void)
+{
+    CSmallTimeAndDate time;
+    time.GetActualTimeAndDate();
+    int now = time.GetSecondsFromBeginning();
+
+    CPathSetPtr paths;
+
+    IndexMutex.Lock();
+        if( (Paths == NULL) || (now - CreationTime >= SOCKET_INDEX_TTL) ){
+            Paths = ReadPaths();
+            CreationTime = now;
+        }
+        paths = Paths;
+    IndexMutex.Unlock();
+
+    return(paths);
+}
+
+//------------------------------------------------------------------------------
+
+CSocketIndex::CPathSetPtr CSocketIndex::ReadPaths(void)
+{
+    boost::shared_ptr<CPathSet> paths(new CPathSet);
+
+    FILE* p_f = fopen("/proc/net/unix","r");
+    if( p_f == NULL ){
+        ES_ERROR("unable to open /proc/net/unix");
+        return(paths);
+    }
+
+    // Num RefCount Protocol Flags Type St Inode Path
+    char    buffer[4096];
+    bool    header = true;
+    while( fgets(buffer,sizeof(buffer),p_f) != NULL ){
+        if( header ){
+            header = false;
+            continue;
+        }
+        int pos = 0;
+        char num[32];
+        unsigned long refcount, protocol, flags, type, st, inode;
+        if( sscanf(buffer,"%31s %lx %lx %lx %lx %lx %lu %n",num,&refcount,&protocol,&flags,&type,&st,&inode,&pos) < 7 ) continue;
+        if( pos <= 0 ) continue;
+
+        // path is optional - unnamed sockets
+        char* p_path = buffer + pos;
+        size_t len = strlen(p_path);
+        while( (len > 0) && ((p_path[len-1] == '\n') || (p_path[len-1] == ' ')) ) len--;
+        if( len == 0 ) continue;
+
+        paths->insert(string(p_path,len));
+    }
+
+    fclose(p_f);
+
+    return(paths);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,69 @@
+#ifndef SocketIndexH
+#define SocketIndexH
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SimpleMutex.hpp>
+#include <SmallString.hpp>
+#include <string>
+#include <boost/unordered_set.hpp>
+#include <boost/shared_ptr.hpp>
+
+//------------------------------------------------------------------------------
+
+// how long the list of bound unix sockets is reused (in seconds)
+#define SOCKET_INDEX_TTL        2
+
+//------------------------------------------------------------------------------
+
+//! index of bound unix domain sockets
+/*!
+  /proc/net/unix is read in-process at most once per SOCKET_INDEX_TTL,
+  the index is then shared by all lookups
+*/
+
+class CSocketIndex {
+public:
+// constructor -----------------------------------------------------------------
+    CSocketIndex(void);
+
+// executive methods -----------------------------------------------------------
+    //! is there a socket bound to the path?
+    bool IsBound(const CSmallString& path);
+
+// section of private data -----------------------------------------------------
+private:
+    typedef boost::unordered_set<std::string>   CPathSet;
+    typedef boost::shared_ptr<const CPathSet>   CPathSetPtr;
+
+    CSimpleMutex    IndexMutex;
+    CPathSetPtr     Paths;
+    int             CreationTime;
+
+    // get current index, it is rebuilt when expired
+    CPathSetPtr GetPaths(void);
+
+    // read /proc/net/unix
+    static CPathSetPtr ReadPaths(void);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
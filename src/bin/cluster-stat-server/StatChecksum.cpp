@@ -0,0 +1,148 @@
+// =============================================================================
+// cluster-stat-client
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <StatChecksum.hpp>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+
+#define CRC32C_POLY 0x82F63B78u     // reflected Castagnoli polynomial
+
+typedef unsigned int (*CRC32C_FCE)(unsigned int,const unsigned char*,size_t);
+
+//------------------------------------------------------------------------------
+
+class CCRC32CTable {
+public:
+    CCRC32CTable(void);
+
+    unsigned int    Table[256];
+    CRC32C_FCE      Update;
+    bool            HW;
+};
+
+//------------------------------------------------------------------------------
+
+static unsigned int UpdateSoft(unsigned int crc,const unsigned char* p_data,size_t len);
+
+#if defined(__x86_64__)
+static unsigned int UpdateHW(unsigned int crc,const unsigned char* p_data,size_t len) __attribute__((target("sse4.2")));
+#endif
+
+// table and dispatch are set up before main()
+static CCRC32CTable CRC32C;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CCRC32CTable::CCRC32CTable(void)
+{
+    for(unsigned int i=0; i < 256; i++){
+        unsigned int crc = i;
+        for(int k=0; k < 8; k++){
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        }
+        Table[i] = crc;
+    }
+
+    Update = UpdateSoft;
+    HW = false;
+
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports("sse4.2") ){
+        Update = UpdateHW;
+        HW = true;
+    }
+#endif
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+static unsigned int UpdateSoft(unsigned int crc,const unsigned char* p_data,size_t len)
+{
+    for(size_t i=0; i < len; i++){
+        crc = CRC32C.Table[(crc ^ p_data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return(crc);
+}
+
+//------------------------------------------------------------------------------
+
+#if defined(__x86_64__)
+
+static unsigned int UpdateHW(unsigned int crc,const unsigned char* p_data,size_t len)
+{
+    uint64_t crc64 = crc;
+
+    while( len >= 8 ){
+        uint64_t value;
+        memcpy(&value,p_data,8);
+        crc64 = _mm_crc32_u64(crc64,value);
+        p_data += 8;
+        len -= 8;
+    }
+
+    crc = crc64;
+    while( len > 0 ){
+        crc = _mm_crc32_u8(crc,*p_data);
+        p_data++;
+        len--;
+    }
+
+    return(crc);
+}
+
+#endif
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+unsigned int StatCRC32C(unsigned int crc,const void* p_data,size_t len)
+{
+    return( ~CRC32C.Update(~crc,static_cast<const unsigned char*>(p_data),len) );
+}
+
+//------------------------------------------------------------------------------
+
+unsigned int StatCRC32CSoft(unsigned int crc,const void* p_data,size_t len)
+{
+    return( ~UpdateSoft(~crc,static_cast<const unsigned char*>(p_data),len) );
+}
+
+//------------------------------------------------------------------------------
+
+bool StatCRC32CIsHW(void)
+{
+    return(CRC32C.HW);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
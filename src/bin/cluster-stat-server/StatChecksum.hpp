@@ -0,0 +1,41 @@
+#ifndef StatChecksumH
+#define StatChecksumH
+// =============================================================================
+// cluster-stat-client
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+
+//! CRC32C (Castagnoli), it can be chained over several blocks
+/*!
+  start with crc = 0, SSE4.2 instruction is used when the CPU supports it
+*/
+unsigned int StatCRC32C(unsigned int crc,const void* p_data,size_t len);
+
+//! CRC32C - portable implementation
+unsigned int StatCRC32CSoft(unsigned int crc,const void* p_data,size_t len);
+
+//! is hardware CRC32C used?
+bool StatCRC32CIsHW(void);
+
+// -----------------------------------------------------------------------------
+
+#endif
@@ -19,6 +19,8 @@
 // =============================================================================
 
 #include <StatDatagram.hpp>
+#include <StatPacket.hpp>
+#include <StatChecksum.hpp>
 #include <string.h>
 #include <SmallTimeAndDate.hpp>
 #include <string>
@@ -44,13 +46,40 @@ using namespace std;
 using namespace boost;
 using namespace boost::algorithm;
 
+//------------------------------------------------------------------------------
+
+// state hash must not depend on in-memory layout, byte order, or limits
+
+static unsigned int HashString(unsigned int hash,const char* p_str)
+{
+    return(StatCRC32C(hash,p_str,strlen(p_str)+1));
+}
+
+//------------------------------------------------------------------------------
+
+static unsigned int HashInt(unsigned int hash,unsigned int value)
+{
+    unsigned char data[4];
+    data[0] = (value >> 24) & 0xFF;
+    data[1] = (value >> 16) & 0xFF;
+    data[2] = (value >> 8) & 0xFF;
+    data[3] = value & 0xFF;
+    return(StatCRC32C(hash,data,4));
+}
+
+//------------------------------------------------------------------------------
+
+static unsigned int HashChar(unsigned int hash,char value)
+{
+    return(StatCRC32C(hash,&value,1));
+}
+
 //==============================================================================
 //------------------------------------------------------------------------------
 //==============================================================================
 
 CStatDatagram::CStatDatagram(void)
 {
-    memset(Header,0,HEADER_SIZE);
     memset(NodeName,0,NAME_SIZE);
     memset(FullNodeName,0,NAME_SIZE);
     memset(LocalUserName,0,NAME_SIZE*MAX_TTYS);
@@ -70,14 +99,12 @@ CStatDatagram::CStatDatagram(void)
     NumOfVNCRemoteUsers = 0;
     TimeStamp = 0;
     PowerDown = 0;
-    CheckSum = 0;
 }
 
 //------------------------------------------------------------------------------
 
 void CStatDatagram::Clear(void)
 {
-    memset(Header,0,HEADER_SIZE);
     memset(NodeName,0,NAME_SIZE);
     memset(FullNodeName,0,NAME_SIZE);
     memset(LocalUserName,0,NAME_SIZE*MAX_TTYS);
@@ -98,37 +125,13 @@ void CStatDatagram::Clear(void)
 
     TimeStamp = 0;
     PowerDown = 0;
-    CheckSum = 0;
 }
 
 //------------------------------------------------------------------------------
 
-void CStatDatagram::SetDatagram(bool powerdown)
+void CStatDatagram::SetDatagram(const std::list<CUserSession>& sessions,bool powerdown)
 {
-    memset(Header,0,HEADER_SIZE);
-    memset(NodeName,0,NAME_SIZE);
-    memset(FullNodeName,0,NAME_SIZE);
-    memset(LocalUserName,0,NAME_SIZE*MAX_TTYS);
-    memset(LocalLoginName,0,NAME_SIZE*MAX_TTYS);
-    memset(LocalLoginType,0,MAX_TTYS);
-    memset(ActiveLocalUserName,0,NAME_SIZE);
-    memset(ActiveLocalLoginName,0,NAME_SIZE);
-    ActiveLocalLoginType = ' ';
-    memset(RemoteUserName,0,NAME_SIZE*MAX_TTYS);
-    memset(RemoteLoginName,0,NAME_SIZE*MAX_TTYS);
-    memset(RemoteLoginType,' ',MAX_TTYS);
-    memset(RemoteDisplayID,0,NAME_SIZE*MAX_TTYS);
-
-    NumOfLocalUsers = 0;
-    NumOfRemoteUsers = 0;
-    NumOfRDSKRemoteUsers = 0;
-    NumOfVNCRemoteUsers = 0;
-
-    TimeStamp = 0;
-    PowerDown = 0;
-    CheckSum = 0;
-
-    memcpy(Header,"STAT",4);
+    Clear();
 
     gethostname(NodeName,NAME_SIZE-1);
 
@@ -136,137 +139,44 @@ void CStatDatagram::SetDatagram(bool powerdown)
     h = gethostbyname(NodeName);
     strncpy(FullNodeName,h->h_name,NAME_SIZE-1);
 
-    // get list of local sessions
-    std::list<CUserSession> sessions;
-
-    FILE* p_sf = popen("/bin/loginctl --no-legend --no-pager list-sessions","r");
-
-    CSmallString buffer;
-    while( (p_sf != NULL) && (buffer.ReadLineFromFile(p_sf,true,true)) ) {
-        stringstream str(buffer.GetBuffer());
-        string sid;
-        string uid;
-        string user;
-        string seat;
-        string tty;
-        str >> sid >> uid >> user >> seat >> tty;
-        if( ! (sid .empty() || uid.empty() || user.empty()) ){
-            // decode user
-            char login[NAME_SIZE+1];
-            memset(login,0,NAME_SIZE+1);
-            strncpy(login,user.c_str(),NAME_SIZE);
-            struct passwd* my_passwd = getpwnam(login);
-            // only regular users
-            if( (my_passwd != NULL) && (my_passwd->pw_uid > 1000) ){
-                CSmallString name;
-                std::string stext = std::string(my_passwd->pw_gecos);
-                vector<string>  words;
-                split(words,stext,is_any_of(","));
-                if( words.size() >= 1 ){
-                    name = words[0];
-                }
-                CUserSession ses;
-                ses.SessionID = sid;
-                strncpy(ses.UserName,name,NAME_SIZE-1);
-                strncpy(ses.LoginName,login,NAME_SIZE-1);
-                sessions.push_back(ses);
-            }
-        }
-    }
-    if( p_sf ) pclose(p_sf);
-
-    // load active tty
-    CSmallString active_tty;
-    active_tty = "TTY=";
-    FILE* p_tty0 = fopen("/sys/class/tty/tty0/active","r");
-    if( p_tty0 ){
-        active_tty.ReadLineFromFile(p_tty0,true,false);
-        fclose(p_tty0);
-    }
-
-    // deep seesion investigation
-    std::list<CUserSession>::iterator   it = sessions.begin();
-    std::list<CUserSession>::iterator   ie = sessions.end();
+    std::list<CUserSession>::const_iterator   it = sessions.begin();
+    std::list<CUserSession>::const_iterator   ie = sessions.end();
 
     while(it != ie){
-        CUserSession ses = *it;
-        CSmallString cmd;
-        bool remote = false;
-        bool x11 = false;
-        bool wayland = false;
-        bool loctty = false;
-        bool vnc = false;
-        bool rdsk = false;
-        CSmallString displayid = ":n.a.";
-
-        cmd << "/bin/loginctl show-session " << ses.SessionID;
-        FILE* p_sf = popen(cmd,"r");
-        if( p_sf ){
-            CSmallString buffer;
-            while( buffer.ReadLineFromFile(p_sf,true,true) ){
-                if( buffer.FindSubString("Type=x11") != -1 ) x11 = true;
-                if( buffer.FindSubString("Type=wayland") != -1 ) wayland = true;
-                if( buffer.FindSubString("Service=tigervnc") != -1 ) rdsk = true;
-                if( buffer.FindSubString("Remote=yes") != -1 ) remote = true;
-                if( buffer.FindSubString(active_tty) != -1 ) loctty = true;
-            }
-            pclose(p_sf);
-        }
-
-        cmd = NULL;
-        cmd << "/bin/loginctl session-status " << ses.SessionID;
-        p_sf = popen(cmd,"r");
-        if( p_sf ){
-            CSmallString buffer;
-            buffer.SetLength(BUFFER_LEN);   // +1 for \0 is added internally
-            while( buffer.ReadLineFromFile(p_sf,true,true) ){
-                if( buffer.FindSubString("Xvnc") != -1 ) vnc = true;
-                // the terminal space in the string is important
-                if( buffer.FindSubString("/opt/rdsk-full-gui/sbin/vncsession ") != -1){
-                    std::string stext = std::string(buffer);
-                    trim(stext);
-                    vector<string>  words;
-                    split(words,stext,is_any_of(" "),token_compress_on);
-                    if( words.size() == 4 ){
-                        displayid = words[3];
-                    }
-                }
-            }
-            pclose(p_sf);
-        }
+        const CUserSession& ses = *it;
 
-        if( (remote == false) && ((x11 == true) || (wayland == true)) ){
+        if( (ses.Remote == false) && ((ses.X11 == true) || (ses.Wayland == true)) ){
             if( NumOfLocalUsers < MAX_TTYS ){
                 strncpy(LocalUserName[NumOfLocalUsers],ses.UserName,NAME_SIZE-1);
                 strncpy(LocalLoginName[NumOfLocalUsers],ses.LoginName,NAME_SIZE-1);
-                if( wayland == true ){
-                    LocalLoginType[NumOfRemoteUsers] = 'W';
+                if( ses.Wayland == true ){
+                    LocalLoginType[NumOfLocalUsers] = 'W';
                 } else {
-                    LocalLoginType[NumOfRemoteUsers] = 'X';
+                    LocalLoginType[NumOfLocalUsers] = 'X';
                 }
-                if( loctty ){
-                    ActiveLocalLoginType = LocalLoginType[NumOfRemoteUsers];
+                if( ses.ActiveTTY ){
+                    ActiveLocalLoginType = LocalLoginType[NumOfLocalUsers];
                     strncpy(ActiveLocalUserName,ses.UserName,NAME_SIZE-1);
                     strncpy(ActiveLocalLoginName,ses.LoginName,NAME_SIZE-1);
                 }
                 NumOfLocalUsers++;
             }
         }
-        if( remote == true ){
+        if( ses.Remote == true ){
             if( NumOfRemoteUsers < MAX_TTYS ){
                 strncpy(RemoteUserName[NumOfRemoteUsers],ses.UserName,NAME_SIZE-1);
                 strncpy(RemoteLoginName[NumOfRemoteUsers],ses.LoginName,NAME_SIZE-1);
-                strncpy(RemoteDisplayID[NumOfRemoteUsers],displayid,NAME_SIZE-1);
-                if( rdsk == true ){
+                strncpy(RemoteDisplayID[NumOfRemoteUsers],ses.DisplayID.c_str(),NAME_SIZE-1);
+                if( ses.RDSK == true ){
                     RemoteLoginType[NumOfRemoteUsers] = 'R';
-                } else if( vnc == true ){
+                } else if( ses.VNC == true ){
                     RemoteLoginType[NumOfRemoteUsers] = 'V';
                 } else {
                     RemoteLoginType[NumOfRemoteUsers] = 'S';
                 }
                 NumOfRemoteUsers++;
-                if( rdsk == true ) NumOfRDSKRemoteUsers++;
-                if( vnc == true )  NumOfVNCRemoteUsers++;
+                if( ses.RDSK == true ) NumOfRDSKRemoteUsers++;
+                if( ses.VNC == true )  NumOfVNCRemoteUsers++;
             }
         }
 
@@ -298,52 +208,6 @@ void CStatDatagram::SetDatagram(bool powerdown)
     CSmallTimeAndDate time;
     time.GetActualTimeAndDate();
     TimeStamp = time.GetSecondsFromBeginning();
-
-    // calculate checksum
-    for(size_t i=0; i < HEADER_SIZE; i++){
-        CheckSum += Header[i];
-    }
-    for(size_t i=0; i < NAME_SIZE; i++){
-        CheckSum += (unsigned char)NodeName[i];
-    }
-    for(size_t i=0; i < NAME_SIZE; i++){
-        CheckSum += (unsigned char)FullNodeName[i];
-    }
-    for(size_t k=0; k < MAX_TTYS; k++){
-        for(size_t i=0; i < NAME_SIZE; i++){
-            CheckSum += (unsigned char)LocalUserName[k][i];
-            CheckSum += (unsigned char)LocalLoginName[k][i];
-        }
-    }
-    for(size_t i=0; i < MAX_TTYS; i++){
-        CheckSum += (unsigned char)LocalLoginType[i];
-    }
-    for(size_t i=0; i < NAME_SIZE; i++){
-        CheckSum += (unsigned char)ActiveLocalUserName[i];
-    }
-    for(size_t i=0; i < NAME_SIZE; i++){
-        CheckSum += (unsigned char)ActiveLocalLoginName[i];
-    }
-
-    CheckSum += (unsigned char)ActiveLocalLoginType;
-
-    for(size_t k=0; k < MAX_TTYS; k++){
-        for(size_t i=0; i < NAME_SIZE; i++){
-            CheckSum += (unsigned char)RemoteUserName[k][i];
-            CheckSum += (unsigned char)RemoteLoginName[k][i];
-            CheckSum += (unsigned char)RemoteDisplayID[k][i];
-        }
-    }
-    for(size_t i=0; i < MAX_TTYS; i++){
-        CheckSum += (unsigned char)RemoteLoginType[i];
-    }
-
-    CheckSum += NumOfLocalUsers;
-    CheckSum += NumOfRemoteUsers;
-    CheckSum += NumOfRDSKRemoteUsers;
-    CheckSum += NumOfVNCRemoteUsers;
-    CheckSum += PowerDown;
-    CheckSum += TimeStamp;
 }
 
 //------------------------------------------------------------------------------
@@ -355,63 +219,190 @@ void CStatDatagram::SetNodeName(const CSmallString& name)
 
 //------------------------------------------------------------------------------
 
-bool CStatDatagram::IsValid(void)
+size_t CStatDatagram::Serialize(char* p_buffer,size_t size)
 {
-    int checksum = 0;
+    CStatPacketWriter packet(p_buffer,size,ESPT_DATAGRAM);
+
+    NodeName[NAME_SIZE-1] = '\0';
+    FullNodeName[NAME_SIZE-1] = '\0';
 
-    // calculate checksum
-    for(size_t i=0; i < HEADER_SIZE; i++){
-        checksum += Header[i];
+    packet.PutString(ESPG_NODE_NAME,NodeName);
+    packet.PutString(ESPG_FULL_NODE_NAME,FullNodeName);
+    packet.PutInt(ESPG_TIME_STAMP,TimeStamp);
+    packet.PutInt(ESPG_POWER_DOWN,PowerDown);
+    packet.PutInt(ESPG_REMOTE_COUNTS,NumOfVNCRemoteUsers,NumOfRDSKRemoteUsers);
+
+    if( (ActiveLocalUserName[0] != '\0') || (ActiveLocalLoginType != ' ') ){
+        packet.PutSession(ESPG_ACTIVE_SESSION,ActiveLocalLoginType,GetLocalUserName(),GetLocalLoginName(),"");
     }
-    for(size_t i=0; i < NAME_SIZE; i++){
-        checksum += (unsigned char)NodeName[i];
+    for(int id=0; id < NumOfLocalUsers; id++){
+        packet.PutSession(ESPG_LOCAL_SESSION,GetLocalLoginType(id),GetLocalUserName(id),GetLocalLoginName(id),"");
     }
-    for(size_t i=0; i < NAME_SIZE; i++){
-        checksum += (unsigned char)FullNodeName[i];
+    for(int id=0; id < NumOfRemoteUsers; id++){
+        packet.PutSession(ESPG_REMOTE_SESSION,GetRemoteLoginType(id),GetRemoteUserName(id),GetRemoteLoginName(id),GetRemoteDisplayID(id));
     }
-    for(size_t k=0; k < MAX_TTYS; k++){
-        for(size_t i=0; i < NAME_SIZE; i++){
-            checksum += (unsigned char)LocalUserName[k][i];
-            checksum += (unsigned char)LocalLoginName[k][i];
-        }
+
+    return(packet.Finish());
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatDatagram::Deserialize(const char* p_buffer,size_t len)
+{
+    Clear();
+
+    switch( GetStatPacketType(p_buffer,len) ){
+        case ESPT_DATAGRAM:
+            break;
+        case ESPT_LEGACY_V3:
+            return(DeserializeV3(p_buffer,len));
+        default:
+            return(false);
     }
-    for(size_t i=0; i < MAX_TTYS; i++){
-        checksum += (unsigned char)LocalLoginType[i];
+
+    CStatPacketReader packet(p_buffer,len);
+    if( packet.Open(ESPT_DATAGRAM) == false ) return(false);
+
+    while( packet.NextRecord() ){
+        unsigned int    v1 = 0, v2 = 0;
+        char            display[NAME_SIZE];
+        bool            result = true;
+
+        switch( packet.GetTag() ){
+            case ESPG_NODE_NAME:
+                result = packet.GetString(NodeName,NAME_SIZE);
+                break;
+            case ESPG_FULL_NODE_NAME:
+                result = packet.GetString(FullNodeName,NAME_SIZE);
+                break;
+            case ESPG_TIME_STAMP:
+                result = packet.GetInt(v1);
+                TimeStamp = v1;
+                break;
+            case ESPG_POWER_DOWN:
+                result = packet.GetInt(v1);
+                PowerDown = v1;
+                break;
+            case ESPG_REMOTE_COUNTS:
+                result = packet.GetInt(v1,v2);
+                NumOfVNCRemoteUsers = v1;
+                NumOfRDSKRemoteUsers = v2;
+                break;
+            case ESPG_ACTIVE_SESSION:
+                result = packet.GetSession(ActiveLocalLoginType,ActiveLocalUserName,ActiveLocalLoginName,display,NAME_SIZE);
+                break;
+            case ESPG_LOCAL_SESSION:
+                if( NumOfLocalUsers >= MAX_TTYS ) break;
+                result = packet.GetSession(LocalLoginType[NumOfLocalUsers],LocalUserName[NumOfLocalUsers],
+                                           LocalLoginName[NumOfLocalUsers],display,NAME_SIZE);
+                if( result ) NumOfLocalUsers++;
+                break;
+            case ESPG_REMOTE_SESSION:
+                if( NumOfRemoteUsers >= MAX_TTYS ) break;
+                result = packet.GetSession(RemoteLoginType[NumOfRemoteUsers],RemoteUserName[NumOfRemoteUsers],
+                                           RemoteLoginName[NumOfRemoteUsers],RemoteDisplayID[NumOfRemoteUsers],NAME_SIZE);
+                if( result ) NumOfRemoteUsers++;
+                break;
+            default:
+                // unknown record - skip it
+                break;
+        }
+        if( result == false ) return(false);
     }
-    for(size_t i=0; i < NAME_SIZE; i++){
-        checksum += (unsigned char)ActiveLocalUserName[i];
+
+    return(packet.IsComplete());
+}
+
+//------------------------------------------------------------------------------
+
+size_t CStatDatagram::SerializeV3(char* p_buffer,size_t size)
+{
+    if( size < sizeof(CStatDatagramV3) ) return(0);
+
+    CStatDatagramV3 v3;
+    memset(&v3,0,sizeof(v3));
+
+    memcpy(v3.Header,STAT_PACKET_MAGIC,V3_HEADER_SIZE);
+    strncpy(v3.NodeName,NodeName,V3_NAME_SIZE-1);
+    strncpy(v3.FullNodeName,FullNodeName,V3_NAME_SIZE-1);
+
+    strncpy(v3.ActiveLocalUserName,ActiveLocalUserName,V3_NAME_SIZE-1);
+    strncpy(v3.ActiveLocalLoginName,ActiveLocalLoginName,V3_NAME_SIZE-1);
+    v3.ActiveLocalLoginType = ActiveLocalLoginType;
+
+    for(int id=0; (id < NumOfLocalUsers) && (id < V3_MAX_TTYS); id++){
+        strncpy(v3.LocalUserName[id],LocalUserName[id],V3_NAME_SIZE-1);
+        strncpy(v3.LocalLoginName[id],LocalLoginName[id],V3_NAME_SIZE-1);
+        v3.LocalLoginType[id] = LocalLoginType[id];
+        v3.NumOfLocalUsers++;
     }
-    for(size_t i=0; i < NAME_SIZE; i++){
-        checksum += (unsigned char)ActiveLocalLoginName[i];
+
+    for(int id=0; (id < NumOfRemoteUsers) && (id < V3_MAX_TTYS); id++){
+        strncpy(v3.RemoteUserName[id],RemoteUserName[id],V3_NAME_SIZE-1);
+        strncpy(v3.RemoteLoginName[id],RemoteLoginName[id],V3_NAME_SIZE-1);
+        strncpy(v3.RemoteDisplayID[id],RemoteDisplayID[id],V3_NAME_SIZE-1);
+        v3.RemoteLoginType[id] = RemoteLoginType[id];
+        v3.NumOfRemoteUsers++;
     }
+    v3.NumOfVNCRemoteUsers = NumOfVNCRemoteUsers;
+    v3.NumOfRDSKRemoteUsers = NumOfRDSKRemoteUsers;
 
-    checksum += (unsigned char)ActiveLocalLoginType;
+    v3.PowerDown = PowerDown;
+    v3.TimeStamp = TimeStamp;
+    v3.CheckSum = v3.GetCheckSum();
 
-    for(size_t k=0; k < MAX_TTYS; k++){
-        for(size_t i=0; i < NAME_SIZE; i++){
-            checksum += (unsigned char)RemoteUserName[k][i];
-            checksum += (unsigned char)RemoteLoginName[k][i];
-            checksum += (unsigned char)RemoteDisplayID[k][i];
-        }
+    memcpy(p_buffer,&v3,sizeof(v3));
+    return(sizeof(v3));
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatDatagram::DeserializeV3(const char* p_buffer,size_t len)
+{
+    if( len != sizeof(CStatDatagramV3) ) return(false);
+
+    CStatDatagramV3 v3;
+    memcpy(&v3,p_buffer,sizeof(v3));
+    if( v3.IsValid() == false ) return(false);
+
+    strncpy(NodeName,v3.NodeName,NAME_SIZE-1);
+    strncpy(FullNodeName,v3.FullNodeName,NAME_SIZE-1);
+
+    strncpy(ActiveLocalUserName,v3.ActiveLocalUserName,NAME_SIZE-1);
+    strncpy(ActiveLocalLoginName,v3.ActiveLocalLoginName,NAME_SIZE-1);
+    ActiveLocalLoginType = v3.ActiveLocalLoginType;
+
+    for(int id=0; (id < v3.NumOfLocalUsers) && (id < V3_MAX_TTYS) && (id < MAX_TTYS); id++){
+        v3.LocalUserName[id][V3_NAME_SIZE-1] = '\0';
+        v3.LocalLoginName[id][V3_NAME_SIZE-1] = '\0';
+        strncpy(LocalUserName[id],v3.LocalUserName[id],NAME_SIZE-1);
+        strncpy(LocalLoginName[id],v3.LocalLoginName[id],NAME_SIZE-1);
+        LocalLoginType[id] = v3.LocalLoginType[id];
+        NumOfLocalUsers++;
     }
 
-    for(size_t i=0; i < MAX_TTYS; i++){
-        checksum += (unsigned char)RemoteLoginType[i];
+    for(int id=0; (id < v3.NumOfRemoteUsers) && (id < V3_MAX_TTYS) && (id < MAX_TTYS); id++){
+        v3.RemoteUserName[id][V3_NAME_SIZE-1] = '\0';
+        v3.RemoteLoginName[id][V3_NAME_SIZE-1] = '\0';
+        v3.RemoteDisplayID[id][V3_NAME_SIZE-1] = '\0';
+        strncpy(RemoteUserName[id],v3.RemoteUserName[id],NAME_SIZE-1);
+        strncpy(RemoteLoginName[id],v3.RemoteLoginName[id],NAME_SIZE-1);
+        strncpy(RemoteDisplayID[id],v3.RemoteDisplayID[id],NAME_SIZE-1);
+        RemoteLoginType[id] = v3.RemoteLoginType[id];
+        NumOfRemoteUsers++;
     }
+    NumOfVNCRemoteUsers = v3.NumOfVNCRemoteUsers;
+    NumOfRDSKRemoteUsers = v3.NumOfRDSKRemoteUsers;
 
-    checksum += NumOfLocalUsers;
-    checksum += NumOfRemoteUsers;
-    checksum += NumOfRDSKRemoteUsers;
-    checksum += NumOfVNCRemoteUsers;
-    checksum += PowerDown;
-    checksum += TimeStamp;
+    PowerDown = v3.PowerDown;
+    TimeStamp = v3.TimeStamp;
 
-    return( checksum == CheckSum );
+    return(true);
 }
 
 //------------------------------------------------------------------------------
 
-void CStatDatagram::PrintInfo(std::ostream& vout)
+void CStatDatagram::PrintInfo(std::ostream& vout) const
 {
     vout << "Node (short) = " << GetNodeName() << endl;
     vout << "Node         = " << GetFullNodeName() << endl;
@@ -442,47 +433,44 @@ void CStatDatagram::PrintInfo(std::ostream& vout)
 
 //------------------------------------------------------------------------------
 
-CSmallString CStatDatagram::GetNodeName(void)
+CSmallString CStatDatagram::GetNodeName(void) const
 {
-    NodeName[NAME_SIZE-1] = '\0';
     return(NodeName);
 }
 
 //------------------------------------------------------------------------------
 
-CSmallString CStatDatagram::GetFullNodeName(void)
+CSmallString CStatDatagram::GetFullNodeName(void) const
 {
-    FullNodeName[NAME_SIZE-1] = '\0';
     return(FullNodeName);
 }
 
 //------------------------------------------------------------------------------
 
-CSmallString CStatDatagram::GetLocalUserName(void)
+CSmallString CStatDatagram::GetLocalUserName(void) const
 {
     return(ActiveLocalUserName);
 }
 
 //------------------------------------------------------------------------------
 
-CSmallString CStatDatagram::GetLocalLoginName(void)
+CSmallString CStatDatagram::GetLocalLoginName(void) const
 {
     return(ActiveLocalLoginName);
 }
 
 //------------------------------------------------------------------------------
 
-char CStatDatagram::GetLocalLoginType(void)
+char CStatDatagram::GetLocalLoginType(void) const
 {
     return(ActiveLocalLoginType);
 }
 
 //------------------------------------------------------------------------------
 
-CSmallString CStatDatagram::GetLocalUserName(int id)
+CSmallString CStatDatagram::GetLocalUserName(int id) const
 {
     if( (id >= 0) && (id < MAX_TTYS) ){
-        LocalUserName[id][NAME_SIZE-1] = '\0';
         return(LocalUserName[id]);
     }
     return("");
@@ -490,10 +478,9 @@ CSmallString CStatDatagram::GetLocalUserName(int id)
 
 //------------------------------------------------------------------------------
 
-CSmallString CStatDatagram::GetLocalLoginName(int id)
+CSmallString CStatDatagram::GetLocalLoginName(int id) const
 {
     if( (id >= 0) && (id < MAX_TTYS) ){
-        LocalLoginName[id][NAME_SIZE-1] = '\0';
         return(LocalLoginName[id]);
     }
     return("");
@@ -501,7 +488,7 @@ CSmallString CStatDatagram::GetLocalLoginName(int id)
 
 //------------------------------------------------------------------------------
 
-char CStatDatagram::GetLocalLoginType(int id)
+char CStatDatagram::GetLocalLoginType(int id) const
 {
     if( (id >= 0) && (id < MAX_TTYS) ){
         return(LocalLoginType[id]);
@@ -511,10 +498,9 @@ char CStatDatagram::GetLocalLoginType(int id)
 
 //------------------------------------------------------------------------------
 
-CSmallString CStatDatagram::GetRemoteUserName(int id)
+CSmallString CStatDatagram::GetRemoteUserName(int id) const
 {
     if( (id >= 0) && (id < MAX_TTYS) ){
-        RemoteUserName[id][NAME_SIZE-1] = '\0';
         return(RemoteUserName[id]);
     }
     return("");
@@ -522,10 +508,9 @@ CSmallString CStatDatagram::GetRemoteUserName(int id)
 
 //------------------------------------------------------------------------------
 
-CSmallString CStatDatagram::GetRemoteLoginName(int id)
+CSmallString CStatDatagram::GetRemoteLoginName(int id) const
 {
     if( (id >= 0) && (id < MAX_TTYS) ){
-        RemoteLoginName[id][NAME_SIZE-1] = '\0';
         return(RemoteLoginName[id]);
     }
     return("");
@@ -533,7 +518,7 @@ CSmallString CStatDatagram::GetRemoteLoginName(int id)
 
 //------------------------------------------------------------------------------
 
-char CStatDatagram::GetRemoteLoginType(int id)
+char CStatDatagram::GetRemoteLoginType(int id) const
 {
     if( (id >= 0) && (id < MAX_TTYS) ){
         return(RemoteLoginType[id]);
@@ -543,10 +528,9 @@ char CStatDatagram::GetRemoteLoginType(int id)
 
 //------------------------------------------------------------------------------
 
-CSmallString CStatDatagram::GetRemoteDisplayID(int id)
+CSmallString CStatDatagram::GetRemoteDisplayID(int id) const
 {
     if( (id >= 0) && (id < MAX_TTYS) ){
-        RemoteDisplayID[id][NAME_SIZE-1] = '\0';
         return(RemoteDisplayID[id]);
     }
     return(":n.d.");
@@ -554,16 +538,214 @@ CSmallString CStatDatagram::GetRemoteDisplayID(int id)
 
 //------------------------------------------------------------------------------
 
-int CStatDatagram::GetTimeStamp(void)
+int CStatDatagram::GetTimeStamp(void) const
 {
     return(TimeStamp);
 }
 
 //------------------------------------------------------------------------------
 
-bool CStatDatagram::IsDown(void)
+bool CStatDatagram::IsDown(void) const
 {
     return(PowerDown == 1);
 }
 
 //------------------------------------------------------------------------------
+
+unsigned int CStatDatagram::GetStateHash(void) const
+{
+    unsigned int hash = 0;
+
+    hash = HashString(hash,GetNodeName());
+    hash = HashString(hash,GetFullNodeName());
+
+    hash = HashString(hash,GetLocalUserName());
+    hash = HashString(hash,GetLocalLoginName());
+    hash = HashChar(hash,GetLocalLoginType());
+
+    hash = HashInt(hash,NumOfLocalUsers);
+    for(int id=0; id < NumOfLocalUsers; id++){
+        hash = HashString(hash,GetLocalUserName(id));
+        hash = HashString(hash,GetLocalLoginName(id));
+        hash = HashChar(hash,GetLocalLoginType(id));
+    }
+
+    hash = HashInt(hash,NumOfRemoteUsers);
+    hash = HashInt(hash,NumOfVNCRemoteUsers);
+    hash = HashInt(hash,NumOfRDSKRemoteUsers);
+    for(int id=0; id < NumOfRemoteUsers; id++){
+        hash = HashString(hash,GetRemoteUserName(id));
+        hash = HashString(hash,GetRemoteLoginName(id));
+        hash = HashChar(hash,GetRemoteLoginType(id));
+        hash = HashString(hash,GetRemoteDisplayID(id));
+    }
+
+    hash = HashInt(hash,PowerDown);
+
+    return(hash);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CStatHeartbeat::CStatHeartbeat(void)
+{
+    memset(NodeName,0,NAME_SIZE);
+    StateHash = 0;
+    TimeStamp = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void CStatHeartbeat::SetHeartbeat(CStatDatagram& dtg)
+{
+    memset(NodeName,0,NAME_SIZE);
+    strncpy(NodeName,dtg.GetNodeName(),NAME_SIZE-1);
+    StateHash = dtg.GetStateHash();
+
+    CSmallTimeAndDate time;
+    time.GetActualTimeAndDate();
+    TimeStamp = time.GetSecondsFromBeginning();
+}
+
+//------------------------------------------------------------------------------
+
+size_t CStatHeartbeat::Serialize(char* p_buffer,size_t size)
+{
+    CStatPacketWriter packet(p_buffer,size,ESPT_HEARTBEAT);
+
+    NodeName[NAME_SIZE-1] = '\0';
+
+    packet.PutString(ESPG_NODE_NAME,NodeName);
+    packet.PutInt(ESPG_STATE_HASH,StateHash);
+    packet.PutInt(ESPG_TIME_STAMP,TimeStamp);
+
+    return(packet.Finish());
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatHeartbeat::Deserialize(const char* p_buffer,size_t len)
+{
+    memset(NodeName,0,NAME_SIZE);
+    StateHash = 0;
+    TimeStamp = 0;
+
+    CStatPacketReader packet(p_buffer,len);
+    if( packet.Open(ESPT_HEARTBEAT) == false ) return(false);
+
+    while( packet.NextRecord() ){
+        unsigned int    value = 0;
+        bool            result = true;
+
+        switch( packet.GetTag() ){
+            case ESPG_NODE_NAME:
+                result = packet.GetString(NodeName,NAME_SIZE);
+                break;
+            case ESPG_STATE_HASH:
+                result = packet.GetInt(value);
+                StateHash = value;
+                break;
+            case ESPG_TIME_STAMP:
+                result = packet.GetInt(value);
+                TimeStamp = value;
+                break;
+            default:
+                // unknown record - skip it
+                break;
+        }
+        if( result == false ) return(false);
+    }
+
+    return(packet.IsComplete());
+}
+
+//------------------------------------------------------------------------------
+
+size_t CStatHeartbeat::SerializeResync(char* p_buffer,size_t size)
+{
+    CStatPacketWriter packet(p_buffer,size,ESPT_RESYNC);
+
+    NodeName[NAME_SIZE-1] = '\0';
+
+    // not longer than the heartbeat itself - no amplification for spoofed sources
+    packet.PutString(ESPG_NODE_NAME,NodeName);
+    packet.PutInt(ESPG_STATE_HASH,StateHash);
+
+    return(packet.Finish());
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatHeartbeat::IsResync(const char* p_buffer,size_t len)
+{
+    char            name[NAME_SIZE];
+    unsigned int    hash = 0;
+
+    memset(name,0,NAME_SIZE);
+
+    CStatPacketReader packet(p_buffer,len);
+    if( packet.Open(ESPT_RESYNC) == false ) return(false);
+
+    while( packet.NextRecord() ){
+        bool result = true;
+
+        switch( packet.GetTag() ){
+            case ESPG_NODE_NAME:
+                result = packet.GetString(name,NAME_SIZE);
+                break;
+            case ESPG_STATE_HASH:
+                result = packet.GetInt(hash);
+                break;
+            default:
+                // unknown record - skip it
+                break;
+        }
+        if( result == false ) return(false);
+    }
+
+    if( packet.IsComplete() == false ) return(false);
+
+    return( (strcmp(name,NodeName) == 0) && (hash == StateHash) );
+}
+
+//------------------------------------------------------------------------------
+
+CSmallString CStatHeartbeat::GetNodeName(void) const
+{
+    return(NodeName);
+}
+
+//------------------------------------------------------------------------------
+
+int CStatHeartbeat::GetTimeStamp(void) const
+{
+    return(TimeStamp);
+}
+
+//------------------------------------------------------------------------------
+
+unsigned int CStatHeartbeat::GetStateHash(void) const
+{
+    return(StateHash);
+}
+
+//==============================================================================
+
+CUserSession::CUserSession(void)
+{
+    memset(UserName,0,NAME_SIZE);
+    memset(LoginName,0,NAME_SIZE);
+    Remote = false;
+    X11 = false;
+    Wayland = false;
+    ActiveTTY = false;
+    VNC = false;
+    RDSK = false;
+    DisplayID = ":n.a.";
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
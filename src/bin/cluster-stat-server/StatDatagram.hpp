@@ -23,10 +23,16 @@
 
 #include <SmallString.hpp>
 #include <ostream>
+#include <string>
+#include <list>
 
 // -----------------------------------------------------------------------------
 
-#define HEADER_SIZE 4
+class CUserSession;
+
+// -----------------------------------------------------------------------------
+
+// in-memory limits, they are not part of the wire format (see StatPacket.hpp)
 #define NAME_SIZE   64
 #define MAX_TTYS    12
 #define BUFFER_LEN  1024
@@ -38,35 +44,46 @@ public:
     CStatDatagram(void);
 
 // setters ---------------------------------------------------------------------
-    void SetDatagram(bool powerdown=false);
+    void SetDatagram(const std::list<CUserSession>& sessions,bool powerdown=false);
     void SetNodeName(const CSmallString& name);
     void Clear(void);
 
+// wire format -----------------------------------------------------------------
+    //! encode datagram, returns packet length or zero if the buffer is too small
+    size_t Serialize(char* p_buffer,size_t size);
+
+    //! decode datagram (v4 packet or legacy v3 memory image)
+    bool Deserialize(const char* p_buffer,size_t len);
+
+    //! encode legacy v3 memory image, it is used only to benchmark old servers
+    size_t SerializeV3(char* p_buffer,size_t size);
+
 // getters ---------------------------------------------------------------------
-    CSmallString GetNodeName(void);             // node name is always short
-    CSmallString GetFullNodeName(void);
+    CSmallString GetNodeName(void) const;       // node name is always short
+    CSmallString GetFullNodeName(void) const;
+
+    CSmallString GetLocalUserName(void) const;  // active user name
+    CSmallString GetLocalLoginName(void) const;
+    char         GetLocalLoginType(void) const;
 
-    CSmallString GetLocalUserName(void);        // active user name
-    CSmallString GetLocalLoginName(void);
-    char         GetLocalLoginType(void);
+    CSmallString GetLocalUserName(int id) const;
+    CSmallString GetLocalLoginName(int id) const;
+    char         GetLocalLoginType(int id) const;
 
-    CSmallString GetLocalUserName(int id);
-    CSmallString GetLocalLoginName(int id);
-    char         GetLocalLoginType(int id);
+    CSmallString GetRemoteUserName(int id) const;
+    CSmallString GetRemoteLoginName(int id) const;
+    char         GetRemoteLoginType(int id) const;
+    CSmallString GetRemoteDisplayID(int id) const;
 
-    CSmallString GetRemoteUserName(int id);
-    CSmallString GetRemoteLoginName(int id);
-    char         GetRemoteLoginType(int id);
-    CSmallString GetRemoteDisplayID(int id);
+    int          GetTimeStamp(void) const;
+    bool         IsDown(void) const;
+    void         PrintInfo(std::ostream& vout) const;
 
-    int          GetTimeStamp(void);
-    bool         IsDown(void);
-    void         PrintInfo(std::ostream& vout);
-    bool         IsValid(void);
+    //! hash of reported sessions and power state (timestamp is not included)
+    unsigned int GetStateHash(void) const;
 
 // private data ----------------------------------------------------------------
 private:
-    char    Header[HEADER_SIZE];
     char    NodeName[NAME_SIZE];
     char    FullNodeName[NAME_SIZE];
     // local users
@@ -90,18 +107,70 @@ private:
     // service information
     int     PowerDown;
     int     TimeStamp;                      // time of "meassurement"
-    int     CheckSum;
+
+    // decode legacy datagram
+    bool DeserializeV3(const char* p_buffer,size_t len);
 
     friend class CFCGIStatServer;
+    friend class CNodeRegistry;
+    friend class CSeatNotifier;
+    friend class CNodeStateStore;
+};
+
+// -----------------------------------------------------------------------------
+
+//! keep-alive packet sent instead of unchanged datagram
+
+class CStatHeartbeat {
+public:
+    CStatHeartbeat(void);
+
+// setters ---------------------------------------------------------------------
+    void SetHeartbeat(CStatDatagram& dtg);
+
+// wire format -----------------------------------------------------------------
+    //! encode heartbeat, returns packet length or zero if the buffer is too small
+    size_t Serialize(char* p_buffer,size_t size);
+
+    //! decode heartbeat
+    bool Deserialize(const char* p_buffer,size_t len);
+
+    //! encode reply to heartbeat with unknown state - full datagram is requested
+    size_t SerializeResync(char* p_buffer,size_t size);
+
+    //! true if the packet is resync request for this heartbeat
+    bool IsResync(const char* p_buffer,size_t len);
+
+// getters ---------------------------------------------------------------------
+    CSmallString GetNodeName(void) const;
+    int          GetTimeStamp(void) const;
+    unsigned int GetStateHash(void) const;
+
+// private data ----------------------------------------------------------------
+private:
+    char            NodeName[NAME_SIZE];
+    unsigned int    StateHash;
+    int             TimeStamp;
 };
 
 // -----------------------------------------------------------------------------
 
 class CUserSession {
+public:
+    CUserSession(void);
+
 public:
     std::string SessionID;
     char        UserName[NAME_SIZE];
     char        LoginName[NAME_SIZE];
+    // session type
+    bool        Remote;
+    bool        X11;
+    bool        Wayland;
+    bool        ActiveTTY;      // session is attached to the active tty
+    bool        VNC;            // Xvnc is running in the session
+    bool        RDSK;           // tigervnc service
+    std::string DisplayID;
 };
 
 // -----------------------------------------------------------------------------
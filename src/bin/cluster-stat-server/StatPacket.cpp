@@ -0,0 +1,419 @@
+// =============================================================================
+// cluster-stat-client
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <StatPacket.hpp>
+#include <StatChecksum.hpp>
+#include <string.h>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+EStatPacketType GetStatPacketType(const char* p_buffer,size_t len)
+{
+    if( len < STAT_PACKET_HEADER_SIZE ) return(ESPT_UNKNOWN);
+    if( memcmp(p_buffer,STAT_PACKET_MAGIC,4) != 0 ) return(ESPT_UNKNOWN);
+
+    if( (unsigned char)p_buffer[4] == STAT_PACKET_VERSION ){
+        switch( (unsigned char)p_buffer[5] ){
+            case ESPT_DATAGRAM:
+                return(ESPT_DATAGRAM);
+            case ESPT_HEARTBEAT:
+                return(ESPT_HEARTBEAT);
+            case ESPT_RESYNC:
+                return(ESPT_RESYNC);
+            default:
+                return(ESPT_UNKNOWN);
+        }
+    }
+
+    // v3 - the magic is followed by the node name
+    if( len == sizeof(CStatDatagramV3) ) return(ESPT_LEGACY_V3);
+
+    return(ESPT_UNKNOWN);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CStatDatagramV3::IsValid(void)
+{
+    return( GetCheckSum() == CheckSum );
+}
+
+//------------------------------------------------------------------------------
+
+int CStatDatagramV3::GetCheckSum(void)
+{
+    int checksum = 0;
+
+    // calculate checksum
+    for(size_t i=0; i < V3_HEADER_SIZE; i++){
+        checksum += Header[i];
+    }
+    for(size_t i=0; i < V3_NAME_SIZE; i++){
+        checksum += (unsigned char)NodeName[i];
+    }
+    for(size_t i=0; i < V3_NAME_SIZE; i++){
+        checksum += (unsigned char)FullNodeName[i];
+    }
+    for(size_t k=0; k < V3_MAX_TTYS; k++){
+        for(size_t i=0; i < V3_NAME_SIZE; i++){
+            checksum += (unsigned char)LocalUserName[k][i];
+            checksum += (unsigned char)LocalLoginName[k][i];
+        }
+    }
+    for(size_t i=0; i < V3_MAX_TTYS; i++){
+        checksum += (unsigned char)LocalLoginType[i];
+    }
+    for(size_t i=0; i < V3_NAME_SIZE; i++){
+        checksum += (unsigned char)ActiveLocalUserName[i];
+    }
+    for(size_t i=0; i < V3_NAME_SIZE; i++){
+        checksum += (unsigned char)ActiveLocalLoginName[i];
+    }
+
+    checksum += (unsigned char)ActiveLocalLoginType;
+
+    for(size_t k=0; k < V3_MAX_TTYS; k++){
+        for(size_t i=0; i < V3_NAME_SIZE; i++){
+            checksum += (unsigned char)RemoteUserName[k][i];
+            checksum += (unsigned char)RemoteLoginName[k][i];
+            checksum += (unsigned char)RemoteDisplayID[k][i];
+        }
+    }
+
+    for(size_t i=0; i < V3_MAX_TTYS; i++){
+        checksum += (unsigned char)RemoteLoginType[i];
+    }
+
+    checksum += NumOfLocalUsers;
+    checksum += NumOfRemoteUsers;
+    checksum += NumOfRDSKRemoteUsers;
+    checksum += NumOfVNCRemoteUsers;
+    checksum += PowerDown;
+    checksum += TimeStamp;
+
+    return(checksum);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CStatPacketWriter::CStatPacketWriter(char* p_buffer,size_t size,EStatPacketType type)
+{
+    Buffer      = reinterpret_cast<unsigned char*>(p_buffer);
+    Size        = size;
+    Pos         = 0;
+    Overflow    = false;
+
+    if( Size > STAT_PACKET_MAX_SIZE ) Size = STAT_PACKET_MAX_SIZE;
+
+    // header - length and checksum are set in Finish()
+    PutBytes(STAT_PACKET_MAGIC,4);
+    PutU8(STAT_PACKET_VERSION);
+    PutU8(type);
+    PutU16(0);
+    PutU32(0);
+}
+
+//------------------------------------------------------------------------------
+
+void CStatPacketWriter::PutInt(int tag,unsigned int value)
+{
+    PutRecordHeader(tag,4);
+    PutU32(value);
+}
+
+//------------------------------------------------------------------------------
+
+void CStatPacketWriter::PutInt(int tag,unsigned int value1,unsigned int value2)
+{
+    PutRecordHeader(tag,8);
+    PutU32(value1);
+    PutU32(value2);
+}
+
+//------------------------------------------------------------------------------
+
+void CStatPacketWriter::PutString(int tag,const char* p_str)
+{
+    size_t len = strlen(p_str);
+    if( len > 0xFFFF ) len = 0xFFFF;
+    PutRecordHeader(tag,len);
+    PutBytes(p_str,len);
+}
+
+//------------------------------------------------------------------------------
+
+void CStatPacketWriter::PutSession(int tag,char type,const char* p_user,const char* p_login,const char* p_display)
+{
+    size_t ulen = strlen(p_user);
+    if( ulen > 0xFF ) ulen = 0xFF;
+    size_t llen = strlen(p_login);
+    if( llen > 0xFF ) llen = 0xFF;
+    size_t dlen = strlen(p_display);
+    if( dlen > 0xFF ) dlen = 0xFF;
+
+    PutRecordHeader(tag,1 + 1 + ulen + 1 + llen + 1 + dlen);
+    PutU8((unsigned char)type);
+    PutU8(ulen);
+    PutBytes(p_user,ulen);
+    PutU8(llen);
+    PutBytes(p_login,llen);
+    PutU8(dlen);
+    PutBytes(p_display,dlen);
+}
+
+//------------------------------------------------------------------------------
+
+size_t CStatPacketWriter::Finish(void)
+{
+    if( Overflow ) return(0);
+
+    Buffer[6] = (Pos >> 8) & 0xFF;
+    Buffer[7] = Pos & 0xFF;
+
+    unsigned int checksum = StatCRC32C(0,Buffer,8);
+    checksum = StatCRC32C(checksum,Buffer+STAT_PACKET_HEADER_SIZE,Pos-STAT_PACKET_HEADER_SIZE);
+
+    Buffer[8]  = (checksum >> 24) & 0xFF;
+    Buffer[9]  = (checksum >> 16) & 0xFF;
+    Buffer[10] = (checksum >> 8) & 0xFF;
+    Buffer[11] = checksum & 0xFF;
+
+    return(Pos);
+}
+
+//------------------------------------------------------------------------------
+
+void CStatPacketWriter::PutRecordHeader(int tag,size_t len)
+{
+    // the whole record must fit into the buffer
+    if( Pos + 3 + len > Size ){
+        Overflow = true;
+        return;
+    }
+    PutU8(tag);
+    PutU16(len);
+}
+
+//------------------------------------------------------------------------------
+
+void CStatPacketWriter::PutU8(unsigned int value)
+{
+    if( Pos + 1 > Size ){
+        Overflow = true;
+        return;
+    }
+    Buffer[Pos++] = value & 0xFF;
+}
+
+//------------------------------------------------------------------------------
+
+void CStatPacketWriter::PutU16(unsigned int value)
+{
+    PutU8(value >> 8);
+    PutU8(value);
+}
+
+//------------------------------------------------------------------------------
+
+void CStatPacketWriter::PutU32(unsigned int value)
+{
+    PutU16(value >> 16);
+    PutU16(value);
+}
+
+//------------------------------------------------------------------------------
+
+void CStatPacketWriter::PutBytes(const char* p_data,size_t len)
+{
+    if( Pos + len > Size ){
+        Overflow = true;
+        return;
+    }
+    memcpy(Buffer+Pos,p_data,len);
+    Pos += len;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CStatPacketReader::CStatPacketReader(const char* p_buffer,size_t len)
+{
+    Buffer      = reinterpret_cast<const unsigned char*>(p_buffer);
+    Length      = len;
+    Pos         = 0;
+    Tag         = 0;
+    Value       = NULL;
+    ValueLength = 0;
+    Error       = false;
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatPacketReader::Open(EStatPacketType type)
+{
+    Error = true;
+    if( Length < STAT_PACKET_HEADER_SIZE ) return(false);
+    if( memcmp(Buffer,STAT_PACKET_MAGIC,4) != 0 ) return(false);
+    if( Buffer[4] != STAT_PACKET_VERSION ) return(false);
+    if( Buffer[5] != type ) return(false);
+    if( GetU16(Buffer+6) != Length ) return(false);
+
+    unsigned int checksum = StatCRC32C(0,Buffer,8);
+    checksum = StatCRC32C(checksum,Buffer+STAT_PACKET_HEADER_SIZE,Length-STAT_PACKET_HEADER_SIZE);
+    if( GetU32(Buffer+8) != checksum ) return(false);
+
+    Pos   = STAT_PACKET_HEADER_SIZE;
+    Error = false;
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatPacketReader::NextRecord(void)
+{
+    if( Error || (Pos == Length) ) return(false);
+
+    if( Pos + 3 > Length ){
+        Error = true;
+        return(false);
+    }
+    size_t len = GetU16(Buffer+Pos+1);
+    if( Pos + 3 + len > Length ){
+        Error = true;
+        return(false);
+    }
+
+    Tag         = Buffer[Pos];
+    Value       = Buffer + Pos + 3;
+    ValueLength = len;
+    Pos += 3 + len;
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+int CStatPacketReader::GetTag(void)
+{
+    return(Tag);
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatPacketReader::GetInt(unsigned int& value)
+{
+    if( ValueLength != 4 ){
+        Error = true;
+        return(false);
+    }
+    value = GetU32(Value);
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatPacketReader::GetInt(unsigned int& value1,unsigned int& value2)
+{
+    if( ValueLength != 8 ){
+        Error = true;
+        return(false);
+    }
+    value1 = GetU32(Value);
+    value2 = GetU32(Value+4);
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatPacketReader::GetString(char* p_dest,size_t size)
+{
+    if( size == 0 ) return(false);
+    size_t len = ValueLength;
+    if( len > size - 1 ) len = size - 1;
+    memcpy(p_dest,Value,len);
+    p_dest[len] = '\0';
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatPacketReader::GetSession(char& type,char* p_user,char* p_login,char* p_display,size_t size)
+{
+    if( (size == 0) || (ValueLength < 1) ){
+        Error = true;
+        return(false);
+    }
+
+    type = Value[0];
+    size_t pos = 1;
+
+    char* p_dest[3] = {p_user, p_login, p_display};
+    for(int i=0; i < 3; i++){
+        if( pos + 1 > ValueLength ){
+            Error = true;
+            return(false);
+        }
+        size_t slen = Value[pos++];
+        if( pos + slen > ValueLength ){
+            Error = true;
+            return(false);
+        }
+        size_t len = slen;
+        if( len > size - 1 ) len = size - 1;
+        memcpy(p_dest[i],Value+pos,len);
+        p_dest[i][len] = '\0';
+        pos += slen;
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CStatPacketReader::IsComplete(void)
+{
+    return( (Error == false) && (Pos == Length) );
+}
+
+//------------------------------------------------------------------------------
+
+unsigned int CStatPacketReader::GetU16(const unsigned char* p_data)
+{
+    return( (p_data[0] << 8) | p_data[1] );
+}
+
+//------------------------------------------------------------------------------
+
+unsigned int CStatPacketReader::GetU32(const unsigned char* p_data)
+{
+    return( ((unsigned int)p_data[0] << 24) | ((unsigned int)p_data[1] << 16) |
+            ((unsigned int)p_data[2] << 8) | (unsigned int)p_data[3] );
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,194 @@
+#ifndef StatPacketH
+#define StatPacketH
+// =============================================================================
+// cluster-stat-client
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+
+/*
+  wire format (version 4), all integers are in network byte order
+
+  header:
+    0   magic           "STAT"
+    4   version         u8
+    5   type            u8      EStatPacketType
+    6   length          u16     length of the whole packet
+    8   checksum        u32     CRC32C over bytes [0,8) and [12,length)
+
+  body (TLV records):
+    0   tag             u8      EStatPacketTag
+    1   length          u16     length of value
+    3   value
+
+  strings are not zero terminated, unknown tags are skipped
+*/
+
+#define STAT_PACKET_MAGIC       "STAT"
+#define STAT_PACKET_VERSION     4
+#define STAT_PACKET_HEADER_SIZE 12
+#define STAT_PACKET_MAX_SIZE    16384
+
+// -----------------------------------------------------------------------------
+
+enum EStatPacketType {
+    ESPT_UNKNOWN        = 0,
+    ESPT_DATAGRAM       = 1,
+    ESPT_HEARTBEAT      = 2,
+    ESPT_LEGACY_V3      = 3,    // raw CStatDatagramV3 memory image
+    ESPT_RESYNC         = 4,    // server -> client, full datagram is requested
+};
+
+// -----------------------------------------------------------------------------
+
+enum EStatPacketTag {
+    ESPG_NODE_NAME      = 1,    // string
+    ESPG_FULL_NODE_NAME = 2,    // string
+    ESPG_TIME_STAMP     = 3,    // u32
+    ESPG_POWER_DOWN     = 4,    // u32
+    ESPG_STATE_HASH     = 5,    // u32
+    ESPG_REMOTE_COUNTS  = 6,    // u32 (VNC) + u32 (RDSK)
+    ESPG_LOCAL_SESSION  = 16,   // session record
+    ESPG_ACTIVE_SESSION = 17,   // session record
+    ESPG_REMOTE_SESSION = 18,   // session record
+};
+
+// session record: type (char) + user name + login name + display id,
+// each string is prefixed by its length (u8)
+
+// -----------------------------------------------------------------------------
+
+//! memory image of datagrams sent by version 3 clients
+/*!
+  the layout must not be changed - it is accepted only for backward compatibility
+*/
+
+#define V3_HEADER_SIZE  4
+#define V3_NAME_SIZE    64
+#define V3_MAX_TTYS     12
+
+class CStatDatagramV3 {
+public:
+    //! verify checksum
+    bool    IsValid(void);
+
+    //! calculate checksum
+    int     GetCheckSum(void);
+
+public:
+    char    Header[V3_HEADER_SIZE];
+    char    NodeName[V3_NAME_SIZE];
+    char    FullNodeName[V3_NAME_SIZE];
+    // local users
+    int     NumOfLocalUsers;
+    char    LocalUserName[V3_MAX_TTYS][V3_NAME_SIZE];
+    char    LocalLoginName[V3_MAX_TTYS][V3_NAME_SIZE];
+    char    LocalLoginType[V3_MAX_TTYS];
+
+    char    ActiveLocalUserName[V3_NAME_SIZE];
+    char    ActiveLocalLoginName[V3_NAME_SIZE];
+    char    ActiveLocalLoginType;
+
+    // remote users
+    int     NumOfRemoteUsers;
+    int     NumOfVNCRemoteUsers;
+    int     NumOfRDSKRemoteUsers;
+    char    RemoteUserName[V3_MAX_TTYS][V3_NAME_SIZE];
+    char    RemoteLoginName[V3_MAX_TTYS][V3_NAME_SIZE];
+    char    RemoteLoginType[V3_MAX_TTYS];
+    char    RemoteDisplayID[V3_MAX_TTYS][V3_NAME_SIZE];
+    // service information
+    int     PowerDown;
+    int     TimeStamp;
+    int     CheckSum;
+};
+
+// -----------------------------------------------------------------------------
+
+//! determine type of received packet
+EStatPacketType GetStatPacketType(const char* p_buffer,size_t len);
+
+// -----------------------------------------------------------------------------
+
+class CStatPacketWriter {
+public:
+    CStatPacketWriter(char* p_buffer,size_t size,EStatPacketType type);
+
+    void    PutInt(int tag,unsigned int value);
+    void    PutInt(int tag,unsigned int value1,unsigned int value2);
+    void    PutString(int tag,const char* p_str);
+    void    PutSession(int tag,char type,const char* p_user,const char* p_login,const char* p_display);
+
+    //! finalize packet, returns its length or zero if the buffer is too small
+    size_t  Finish(void);
+
+private:
+    unsigned char*  Buffer;
+    size_t          Size;
+    size_t          Pos;
+    bool            Overflow;
+
+    void    PutRecordHeader(int tag,size_t len);
+    void    PutU8(unsigned int value);
+    void    PutU16(unsigned int value);
+    void    PutU32(unsigned int value);
+    void    PutBytes(const char* p_data,size_t len);
+};
+
+// -----------------------------------------------------------------------------
+
+class CStatPacketReader {
+public:
+    CStatPacketReader(const char* p_buffer,size_t len);
+
+    //! check header and checksum
+    bool    Open(EStatPacketType type);
+
+    //! move to the next record, false at the end or on error
+    bool    NextRecord(void);
+
+    // current record ----------------------------
+    int     GetTag(void);
+    bool    GetInt(unsigned int& value);
+    bool    GetInt(unsigned int& value1,unsigned int& value2);
+    //! copy string, it is always zero terminated and truncated to size-1
+    bool    GetString(char* p_dest,size_t size);
+    bool    GetSession(char& type,char* p_user,char* p_login,char* p_display,size_t size);
+
+    //! true if the whole body was consumed without errors
+    bool    IsComplete(void);
+
+private:
+    const unsigned char*    Buffer;
+    size_t                  Length;
+    size_t                  Pos;
+    int                     Tag;
+    const unsigned char*    Value;
+    size_t                  ValueLength;
+    bool                    Error;
+
+    static unsigned int GetU16(const unsigned char* p_data);
+    static unsigned int GetU32(const unsigned char* p_data);
+};
+
+// -----------------------------------------------------------------------------
+
+#endif
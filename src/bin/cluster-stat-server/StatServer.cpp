@@ -30,9 +30,13 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#include <stdint.h>
+#include <vector>
 #include <StatServer.hpp>
 #include <StatDatagram.hpp>
+#include <StatPacket.hpp>
 #include <FCGIStatServer.hpp>
+#include <HostResolver.hpp>
 
 //------------------------------------------------------------------------------
 
@@ -48,8 +52,9 @@ CStatServer::CStatServer(void)
 {
     Socket = -1;
     Port = 32598;
-    AllRequests = 0;
-    SuccessfulRequests = 0;
+    RcvBufSize = 0;
+    BatchSize = 32;
+    ReusePort = false;
 }
 
 //------------------------------------------------------------------------------
@@ -68,6 +73,28 @@ void CStatServer::SetPort(int port)
 
 //------------------------------------------------------------------------------
 
+void CStatServer::SetReceiveBuffer(int size)
+{
+    RcvBufSize = size;
+}
+
+//------------------------------------------------------------------------------
+
+void CStatServer::SetBatchSize(int size)
+{
+    if( size < 1 ) size = 1;
+    BatchSize = size;
+}
+
+//------------------------------------------------------------------------------
+
+void CStatServer::SetReusePort(bool set)
+{
+    ReusePort = set;
+}
+
+//------------------------------------------------------------------------------
+
 void CStatServer::TerminateServer(void)
 {
     if( Socket != -1 ) shutdown(Socket, SHUT_RDWR);
@@ -111,6 +138,14 @@ void CStatServer::ExecuteThread(void)
                         rp->ai_protocol);
         if( Socket == -1 ) continue;
 
+        // each receiver has its own socket, the kernel distributes datagrams among them
+        int on = 1;
+        if( ReusePort && (setsockopt(Socket,SOL_SOCKET,SO_REUSEPORT,&on,sizeof(on)) == -1) ){
+            CSmallString error;
+            error << "unable to set SO_REUSEPORT (" << strerror(errno) << ")";
+            ES_ERROR(error);
+        }
+
         if( bind(Socket, rp->ai_addr, rp->ai_addrlen) == 0) break; // Success
 
         close(Socket);
@@ -124,51 +159,153 @@ void CStatServer::ExecuteThread(void)
 
     freeaddrinfo(result); // No longer needed
 
+    // socket setup ----------------------------------
+    if( RcvBufSize > 0 ){
+        if( setsockopt(Socket,SOL_SOCKET,SO_RCVBUF,&RcvBufSize,sizeof(RcvBufSize)) == -1 ){
+            CSmallString error;
+            error << "unable to set SO_RCVBUF (" << strerror(errno) << ")";
+            ES_WARNING(error);
+        }
+        // the kernel doubles the value but it is limited by net.core.rmem_max
+        int       size = 0;
+        socklen_t size_len = sizeof(size);
+        if( (getsockopt(Socket,SOL_SOCKET,SO_RCVBUF,&size,&size_len) == 0) && (size < RcvBufSize) ){
+            CSmallString error;
+            error << "SO_RCVBUF is limited to " << size << " bytes (increase net.core.rmem_max)";
+            ES_WARNING(error);
+        }
+    }
+
+    // the kernel reports number of dropped datagrams in each message
+    int on = 1;
+    if( setsockopt(Socket,SOL_SOCKET,SO_RXQ_OVFL,&on,sizeof(on)) == -1 ){
+        CSmallString error;
+        error << "unable to set SO_RXQ_OVFL (" << strerror(errno) << ")";
+        ES_WARNING(error);
+    }
+
+    // preallocated buffers ----------------------------
+    std::vector<char>                       buffers(BatchSize*STAT_PACKET_MAX_SIZE);
+    std::vector<struct mmsghdr>             msgs(BatchSize);
+    std::vector<struct iovec>               iovecs(BatchSize);
+    std::vector<struct sockaddr_storage>    peers(BatchSize);
+    std::vector<char>                       controls(BatchSize*CMSG_SPACE(sizeof(uint32_t)));
+
     // server loop
     while( (ThreadTerminated == false) && (Socket != -1) ) {
 
-        CStatDatagram           datagram;
-        struct sockaddr_storage peer_addr;
-        socklen_t               peer_addr_len;
-        ssize_t                 nread;
+        // get datagrams -----------------------------
+        for(int i=0; i < BatchSize; i++){
+            iovecs[i].iov_base              = &buffers[i*STAT_PACKET_MAX_SIZE];
+            iovecs[i].iov_len               = STAT_PACKET_MAX_SIZE;
+            memset(&msgs[i],0,sizeof(struct mmsghdr));
+            msgs[i].msg_hdr.msg_iov         = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen      = 1;
+            msgs[i].msg_hdr.msg_name        = &peers[i];
+            msgs[i].msg_hdr.msg_namelen     = sizeof(struct sockaddr_storage);
+            msgs[i].msg_hdr.msg_control     = &controls[i*CMSG_SPACE(sizeof(uint32_t))];
+            msgs[i].msg_hdr.msg_controllen  = CMSG_SPACE(sizeof(uint32_t));
+        }
 
-        // get datagram ------------------------------
-        peer_addr_len = sizeof(struct sockaddr_storage);
-        nread = recvfrom(Socket,&datagram,sizeof(datagram), 0,
-                         (struct sockaddr *)&peer_addr, &peer_addr_len);
+        // wait for the first datagram, then take all pending ones
+        int nmsgs = recvmmsg(Socket,&msgs[0],BatchSize,MSG_WAITFORONE,NULL);
+        if( nmsgs <= 0 ) continue;              // Ignore failed request
 
-        AllRequests++;
+        Metrics.ReceiveBatches.Inc();
 
-        if(nread == -1) continue;                   // Ignore failed request
-        if(nread != sizeof(datagram) ) continue;    // Ignore incomplete request
+        for(int i=0; i < nmsgs; i++){
+            Metrics.Datagrams.Inc();
 
-        char host[NI_MAXHOST], service[NI_MAXSERV];
-        memset(host,0,NI_MAXHOST);
+            // drop counter ------------------------------
+            for(struct cmsghdr* p_cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); p_cmsg != NULL;
+                p_cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr,p_cmsg)){
+                if( (p_cmsg->cmsg_level == SOL_SOCKET) && (p_cmsg->cmsg_type == SO_RXQ_OVFL) ){
+                    uint32_t drops;
+                    memcpy(&drops,CMSG_DATA(p_cmsg),sizeof(drops));
+                    KernelDrops.Set(drops);
+                }
+            }
 
-        // get client hostname -----------------------
-        s = getnameinfo((struct sockaddr *) &peer_addr,
-                        peer_addr_len, host, NI_MAXHOST-1,
-                        service, NI_MAXSERV-1, NI_NUMERICSERV);
-        if(s != 0) {
-            // client hostname is not available
+            ProcessPacket(&buffers[i*STAT_PACKET_MAX_SIZE],msgs[i].msg_len,
+                          (struct sockaddr*)&peers[i],msgs[i].msg_hdr.msg_namelen);
+        }
+    }
+
+    return;
+}
+
+//------------------------------------------------------------------------------
+
+void CStatServer::ProcessPacket(const char* p_buffer,size_t len,struct sockaddr* p_peer,socklen_t peer_len)
+{
+    CStatDatagram           datagram;
+    CStatHeartbeat          heartbeat;
+
+    EStatPacketType type = GetStatPacketType(p_buffer,len);
+    // resync requests are sent only by servers
+    if( (type == ESPT_UNKNOWN) || (type == ESPT_RESYNC) ){  // Ignore unknown or incomplete request
+        Metrics.DroppedDatagrams[EMD_UNKNOWN_TYPE].Inc();
+        return;
+    }
+
+    char host[NI_MAXHOST];
+    memset(host,0,NI_MAXHOST);
+
+    // get client address ------------------------
+    // numeric only - names are resolved asynchronously by HostResolver,
+    // it is used only for error messages to keep the shared lock out of the hot path
+    int s = getnameinfo(p_peer, peer_len, host, NI_MAXHOST-1,
+                        NULL, 0, NI_NUMERICHOST);
+    if(s != 0) {
+        CSmallString error;
+        error << "getnameinfo: " << gai_strerror(s);
+        ES_ERROR(error);
+        Metrics.DroppedDatagrams[EMD_ADDRESS].Inc();
+        return;
+    }
+
+    // keep-alive packet -------------------------
+    if( type == ESPT_HEARTBEAT ){
+        if( heartbeat.Deserialize(p_buffer,len) == false ) {
+            HostResolver.Submit(host);
             CSmallString error;
-            error << "getnameinfo: " << gai_strerror(s);
+            error << "heartbeat from " << HostResolver.GetName(host) << " is not valid (checksum error)";
             ES_ERROR(error);
-            continue;
+            Metrics.DroppedDatagrams[EMD_CHECKSUM].Inc();
+            return;
         }
-
-        // validate datagram -------------------------
-        if( datagram.IsValid() == false ) {
-            ES_ERROR("datagram is not valid (checksum error)");
-            continue;
+        // unknown state - ask the client for full datagram
+        if( ClusterStatServer.RefreshNode(heartbeat) == false ){
+            Metrics.DroppedDatagrams[EMD_UNKNOWN_STATE].Inc();
+            char   reply[STAT_PACKET_MAX_SIZE];
+            size_t size = heartbeat.SerializeResync(reply,sizeof(reply));
+            if( (size > 0) && (sendto(Socket,reply,size,MSG_DONTWAIT,p_peer,peer_len) == (ssize_t)size) ){
+                Metrics.ResyncRequests.Inc();
+            }
+            return;
         }
+        Metrics.Heartbeats.Inc();
+        Metrics.AcceptedDatagrams.Inc();
+        return;
+    }
 
-        ClusterStatServer.RegisterNode(datagram);
+    // validate datagram -------------------------
+    if( datagram.Deserialize(p_buffer,len) == false ) {
+        HostResolver.Submit(host);
+        CSmallString error;
+        error << "datagram from " << HostResolver.GetName(host) << " is not valid (checksum error)";
+        ES_ERROR(error);
+        Metrics.DroppedDatagrams[EMD_CHECKSUM].Inc();
+        return;
+    }
 
-        SuccessfulRequests++;
+    if( ClusterStatServer.RegisterNode(datagram) == false ){
+        Metrics.DroppedDatagrams[EMD_TOO_MANY_NODES].Inc();
+        return;
     }
 
-    return;
+    if( type == ESPT_LEGACY_V3 ) Metrics.LegacyDatagrams.Inc();
+    Metrics.AcceptedDatagrams.Inc();
 }
 
 //==============================================================================
@@ -21,6 +21,10 @@
 // =============================================================================
 
 #include <SmartThread.hpp>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <boost/shared_ptr.hpp>
+#include <Metrics.hpp>
 
 //------------------------------------------------------------------------------
 
@@ -33,17 +37,32 @@ public:
     ///! set server port
     void SetPort(int port);
 
+    //! set socket receive buffer size in bytes (SO_RCVBUF), 0 - system default
+    void SetReceiveBuffer(int size);
+
+    //! set max number of datagrams received by one recvmmsg call
+    void SetBatchSize(int size);
+
+    //! share the port with other receivers (SO_REUSEPORT)
+    void SetReusePort(bool set);
+
     //! terminate server, e.g. close socket and termineate thread
     void TerminateServer(void);
 
 public:
-    int AllRequests;
-    int SuccessfulRequests;
+    // other counters are in Metrics
+    CMetricGauge KernelDrops;   // datagrams dropped by kernel (SO_RXQ_OVFL)
 
 // section of private data -----------------------------------------------------
 private:
     int Port;
     int Socket;
+    int RcvBufSize;
+    int BatchSize;
+    bool ReusePort;
+
+    // validate and register one datagram
+    void ProcessPacket(const char* p_buffer,size_t len,struct sockaddr* p_peer,socklen_t peer_len);
 
 // execute server --------------------------------------------------------------
     //! execute server
@@ -53,4 +72,8 @@ private:
 
 // -----------------------------------------------------------------------------
 
+typedef boost::shared_ptr<CStatServer>  CStatServerPtr;
+
+// -----------------------------------------------------------------------------
+
 #endif
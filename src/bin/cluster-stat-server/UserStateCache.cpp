@@ -0,0 +1,87 @@
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <UserStateCache.hpp>
+#include <SmallTimeAndDate.hpp>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CUserState::CUserState(void)
+{
+    QuotaExceeded   = false;
+    HasKerberos     = false;
+    CreationTime    = 0;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CUserStateCache::Get(const std::string& user,const std::string& krb5ccname,CUserState& state)
+{
+    CSmallTimeAndDate time;
+    time.GetActualTimeAndDate();
+    int now = time.GetSecondsFromBeginning();
+
+    bool result = false;
+
+    CacheMutex.Lock();
+        std::map<std::string,CUserState>::iterator it = Cache.find(user);
+        if( (it != Cache.end()) && (it->second.KRB5CCName == krb5ccname) &&
+            (now - it->second.CreationTime < USER_STATE_TTL) ){
+            state = it->second;
+            result = true;
+        }
+    CacheMutex.Unlock();
+
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+void CUserStateCache::Set(const std::string& user,const CUserState& state)
+{
+    CacheMutex.Lock();
+        // drop expired states if there are too many users
+        if( (Cache.count(user) == 0) && (Cache.size() >= USER_STATE_MAX_SIZE) ){
+            std::map<std::string,CUserState>::iterator it = Cache.begin();
+            while( it != Cache.end() ){
+                if( state.CreationTime - it->second.CreationTime >= USER_STATE_TTL ){
+                    Cache.erase(it++);
+                } else {
+                    it++;
+                }
+            }
+        }
+        if( (Cache.count(user) > 0) || (Cache.size() < USER_STATE_MAX_SIZE) ){
+            Cache[user] = state;
+        }
+    CacheMutex.Unlock();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,73 @@
+#ifndef UserStateCacheH
+#define UserStateCacheH
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2019      Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SimpleMutex.hpp>
+#include <map>
+#include <string>
+
+//------------------------------------------------------------------------------
+
+// how long the state of a user is reused (in seconds)
+#define USER_STATE_TTL          10
+
+// max number of cached users
+#define USER_STATE_MAX_SIZE     4096
+
+//------------------------------------------------------------------------------
+
+//! state of user that does not depend on nodes
+/*!
+  quota flag and kerberos ticket are files possibly on NFS, their
+  state is reused for USER_STATE_TTL seconds
+*/
+
+class CUserState {
+public:
+    CUserState(void);
+
+public:
+    bool            QuotaExceeded;
+    bool            HasKerberos;
+    std::string     KRB5CCName;     // the ticket state is valid only for this cache
+    int             CreationTime;
+};
+
+//------------------------------------------------------------------------------
+
+class CUserStateCache {
+public:
+// executive methods -----------------------------------------------------------
+    //! get cached state, false if it is not available or it is expired
+    bool Get(const std::string& user,const std::string& krb5ccname,CUserState& state);
+
+    //! store state
+    void Set(const std::string& user,const CUserState& state);
+
+// section of private data -----------------------------------------------------
+private:
+    CSimpleMutex                        CacheMutex;
+    std::map<std::string,CUserState>    Cache;
+};
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -44,18 +44,18 @@ bool CFCGIStatServer::_Debug(CFCGIRequest& request)
     stringstream str;
     str << "<html><body>" << endl;
 
-    NodesMutex.Lock();
+    CClusterSnapshotPtr snapshot = Nodes.GetSnapshot();
 
-    std::map<std::string,CCompNodePtr>::iterator it = Nodes.begin();
-    std::map<std::string,CCompNodePtr>::iterator ie = Nodes.end();
+    std::vector<CCompNodeConstPtr>::const_iterator it = snapshot->Nodes.begin();
+    std::vector<CCompNodeConstPtr>::const_iterator ie = snapshot->Nodes.end();
 
     while( it != ie ){
-        CStatDatagram dtg = it->second->Basic;
+        const CStatDatagram& dtg = (*it)->Basic;
 
         // check node status
         CSmallString status = "up";
         // check timestamp from user stat file
-        CSmallTimeAndDate stime(dtg.GetTimeStamp());
+        CSmallTimeAndDate stime((*it)->GetTimeStamp());
         CSmallTimeAndDate ctime;
         ctime.GetActualTimeAndDate();
         CSmallTime diff = ctime - stime;
@@ -80,16 +80,10 @@ bool CFCGIStatServer::_Debug(CFCGIRequest& request)
         it++;
     }
 
-    NodesMutex.Unlock();
-
     str << "</body></html>" << endl;
 
-    request.OutStream.PutStr(str.str());
-
-    // finalize request
-    request.FinishRequest();
-
-    return(true);
+    CResponseBody body(str.str());
+    return(SendResponse(request,body));
 }
 
 //==============================================================================
@@ -31,6 +31,8 @@
 
 bool CFCGIStatServer::_Error(CFCGIRequest& request)
 {
+    request.OutStream.PutStr("Content-type: text/html\r\n");
+    request.OutStream.PutStr("\r\n");
     request.OutStream.PutStr("ERROR");
     request.FinishRequest();
     return(true);
@@ -28,6 +28,7 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <sstream>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
 
@@ -40,79 +41,33 @@ using namespace boost;
 
 bool CFCGIStatServer::_ListAllSeats(CFCGIRequest& request)
 {
-    NodesMutex.Lock();
+    CClusterSnapshotPtr snapshot = Nodes.GetSnapshot();
 
-    std::map<std::string,CCompNodePtr>::iterator it = Nodes.begin();
-    std::map<std::string,CCompNodePtr>::iterator ie = Nodes.end();
+    // render the body only once per snapshot
+    CResponseBodyPtr body = ResponseCache.Get("allseats",snapshot);
+    if( body == NULL ){
+        stringstream str;
 
-    while( it != ie ){
-        CStatDatagram dtg = it->second->Basic;
+        std::vector<CCompNodeConstPtr>::const_iterator it = snapshot->Nodes.begin();
+        std::vector<CCompNodeConstPtr>::const_iterator ie = snapshot->Nodes.end();
 
-        // check node status
-        CSmallString status = "up";
-        // check timestamp from user stat file
-        CSmallTimeAndDate stime(dtg.GetTimeStamp());
         CSmallTimeAndDate ctime;
         ctime.GetActualTimeAndDate();
-        CSmallTime diff = ctime - stime;
-        if( (diff > 180) || dtg.IsDown() ){  // skew of 300 seconds
-            status = "down";
-        }
-
-        // write response
-        request.OutStream.PutStr(status); // node status
-        request.OutStream.PutChar(';');
-        request.OutStream.PutStr(dtg.GetNodeName()); // node name
+        int now = ctime.GetSecondsFromBeginning();
 
-        request.OutStream.PutChar(';');
-        request.OutStream.PutStr(CSmallString(dtg.NumOfLocalUsers));
-        request.OutStream.PutChar(',');
-        request.OutStream.PutStr(CSmallString(dtg.NumOfRemoteUsers));
-        request.OutStream.PutChar(',');
-        request.OutStream.PutStr(CSmallString(dtg.NumOfVNCRemoteUsers));
+        while( it != ie ){
+            CSeatNotifier::WriteSeat(str,**it,now);
+            str << '\n';
 
-        if( (dtg.NumOfLocalUsers > 0) || (dtg.NumOfRemoteUsers > 0) ){
-            request.OutStream.PutChar(';');
-        }
-        bool delimit = false;
-        for(int i=0; i < dtg.NumOfLocalUsers; i++){
-            if( delimit ) request.OutStream.PutStr("|");
-            request.OutStream.PutStr(dtg.GetLocalUserName(i));
-            request.OutStream.PutStr(" (");
-            request.OutStream.PutStr(dtg.GetLocalLoginName(i));
-            if( dtg.GetLocalLoginType(i) == 'W' ){
-                request.OutStream.PutStr(") [Wayland]");
-            } else {
-                request.OutStream.PutStr(") [X11]");
-            }
-            delimit = true;
-        }
-        for(int i=0; i < dtg.NumOfRemoteUsers; i++){
-            if( delimit ) request.OutStream.PutStr("|");
-            request.OutStream.PutStr(dtg.GetRemoteUserName(i));
-            request.OutStream.PutStr(" (");
-            request.OutStream.PutStr(dtg.GetRemoteLoginName(i));
-            if( dtg.GetRemoteLoginType(i) == 'R' ){
-                request.OutStream.PutStr(") [RDSK]");
-            } else if( dtg.GetRemoteLoginType(i) == 'V' ){
-                request.OutStream.PutStr(") [VNC]");
-            } else {
-                request.OutStream.PutStr(") [ssh]");
-            }
-            delimit = true;
+            it++;
         }
 
-        request.OutStream.PutChar('\n');
-
-        it++;
+        body = CResponseBodyPtr(new CResponseBody(str.str()));
+        ResponseCache.Set("allseats",snapshot,body);
     }
 
-    NodesMutex.Unlock();
-
-    // finalize request
-    request.FinishRequest();
-
-    return(true);
+    // send the body or only confirm that the client has it
+    return(SendResponse(request,*body));
 }
 
 //==============================================================================
@@ -31,6 +31,7 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <sstream>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
 
@@ -43,46 +44,48 @@ using namespace boost;
 
 bool CFCGIStatServer::_ListLoggedUsers(CFCGIRequest& request)
 {
-    NodesMutex.Lock();
+    CClusterSnapshotPtr snapshot = Nodes.GetSnapshot();
 
-    std::map<std::string,CCompNodePtr>::iterator it = Nodes.begin();
-    std::map<std::string,CCompNodePtr>::iterator ie = Nodes.end();
+    // render the body only once per snapshot
+    CResponseBodyPtr body = ResponseCache.Get("loggedusers",snapshot);
+    if( body == NULL ){
+        stringstream str;
 
-    while( it != ie ){
-        CStatDatagram dtg = it->second->Basic;
+        std::vector<CCompNodeConstPtr>::const_iterator it = snapshot->Nodes.begin();
+        std::vector<CCompNodeConstPtr>::const_iterator ie = snapshot->Nodes.end();
 
-        // check node status
-        CSmallString status = "up";
-        // check timestamp from user stat file
-        CSmallTimeAndDate stime(dtg.GetTimeStamp());
         CSmallTimeAndDate ctime;
         ctime.GetActualTimeAndDate();
-        CSmallTime diff = ctime - stime;
-        if( (diff > 180) || dtg.IsDown() ){  // skew of 180 seconds
-            status = "down";
-        }
 
-        // write response
-        request.OutStream.PutStr(status); // node status
-        request.OutStream.PutChar(';');
-        request.OutStream.PutStr(dtg.GetNodeName()); // node name
-        if( dtg.GetLocalLoginName() != NULL ){
-            request.OutStream.PutChar(';');
-            request.OutStream.PutStr(dtg.GetLocalUserName()); // full user name - optional
-            request.OutStream.PutChar(';');
-            request.OutStream.PutStr(dtg.GetLocalLoginName()); // login name - optional
-        }
-        request.OutStream.PutChar('\n');
+        while( it != ie ){
+            const CStatDatagram& dtg = (*it)->Basic;
 
-        it++;
-    }
+            // check node status
+            const char* status = "up";
+            // check timestamp from user stat file
+            CSmallTimeAndDate stime((*it)->GetTimeStamp());
+            CSmallTime diff = ctime - stime;
+            if( (diff > 180) || dtg.IsDown() ){  // skew of 180 seconds
+                status = "down";
+            }
 
-    NodesMutex.Unlock();
+            // write response
+            str << status << ';' << dtg.GetNodeName(); // node status and name
+            if( dtg.GetLocalLoginName() != NULL ){
+                // full user name and login name - optional
+                str << ';' << dtg.GetLocalUserName() << ';' << dtg.GetLocalLoginName();
+            }
+            str << '\n';
 
-    // finalize request
-    request.FinishRequest();
+            it++;
+        }
+
+        body = CResponseBodyPtr(new CResponseBody(str.str()));
+        ResponseCache.Set("loggedusers",snapshot,body);
+    }
 
-    return(true);
+    // send the body or only confirm that the client has it
+    return(SendResponse(request,*body));
 }
 
 //==============================================================================
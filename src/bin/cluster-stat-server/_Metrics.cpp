@@ -0,0 +1,81 @@
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//     Copyright (C) 2020 Petr Kulhanek (kulhanek@chemi.muni.cz)
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include "FCGIStatServer.hpp"
+#include <ErrorSystem.hpp>
+#include <DebugLog.hpp>
+#include <Metrics.hpp>
+#include <string>
+#include <sstream>
+
+using namespace std;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CFCGIStatServer::_Metrics(CFCGIRequest& request)
+{
+    // write response in Prometheus text format
+    stringstream str;
+
+    Metrics.Print(str);
+
+    str << "# HELP clusterstat_datagrams_kernel_dropped_total Datagrams dropped by kernel on stat sockets.\n";
+    str << "# TYPE clusterstat_datagrams_kernel_dropped_total counter\n";
+    str << "clusterstat_datagrams_kernel_dropped_total " << GetNumOfKernelDrops() << "\n";
+
+    str << "# HELP clusterstat_nodes Number of registered nodes.\n";
+    str << "# TYPE clusterstat_nodes gauge\n";
+    str << "clusterstat_nodes " << Nodes.GetNumOfNodes() << "\n";
+
+    str << "# HELP clusterstat_registry_generation Registry generation.\n";
+    str << "# TYPE clusterstat_registry_generation gauge\n";
+    str << "clusterstat_registry_generation " << Nodes.GetGeneration() << "\n";
+
+    str << "# HELP clusterstat_response_cache_hits_total Response cache hits.\n";
+    str << "# TYPE clusterstat_response_cache_hits_total counter\n";
+    str << "clusterstat_response_cache_hits_total " << ResponseCache.GetHits() << "\n";
+
+    str << "# HELP clusterstat_response_cache_misses_total Response cache misses.\n";
+    str << "# TYPE clusterstat_response_cache_misses_total counter\n";
+    str << "clusterstat_response_cache_misses_total " << ResponseCache.GetMisses() << "\n";
+
+    str << "# HELP clusterstat_watch_rejected_total Rejected watch subscribers.\n";
+    str << "# TYPE clusterstat_watch_rejected_total counter\n";
+    str << "clusterstat_watch_rejected_total " << Notifier.GetNumOfRejected() << "\n";
+
+    str << "# HELP clusterstat_watch_dropped_total Watch subscribers dropped because they did not read their streams.\n";
+    str << "# TYPE clusterstat_watch_dropped_total counter\n";
+    str << "clusterstat_watch_dropped_total " << Notifier.GetNumOfDropped() << "\n";
+
+    str << "# HELP clusterstat_debuglog_dropped_total Dropped debug log messages.\n";
+    str << "# TYPE clusterstat_debuglog_dropped_total counter\n";
+    str << "clusterstat_debuglog_dropped_total " << DebugLog.GetNumOfDropped() << "\n";
+
+    Commands.PrintMetrics(str);
+
+    CResponseBody body(str.str());
+    return(SendResponse(request,body,"text/plain; version=0.0.4"));
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
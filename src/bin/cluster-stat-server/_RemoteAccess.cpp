@@ -78,7 +78,6 @@ bool CFCGIStatServer::_RemoteAccessWakeOnLAN(CFCGIRequest& request,const CSmallS
             CSmallString error;
             error << "illegal node name (" << node << ") from USER (" << ruser << ")";
             ES_ERROR(error);
-            request.FinishRequest();
             return(false);
         }
     }
@@ -92,22 +91,7 @@ bool CFCGIStatServer::_RemoteAccessWakeOnLAN(CFCGIRequest& request,const CSmallS
     ctime.GetActualTimeAndDate();
 
 // mark the node
-    NodesMutex.Lock();
-
-    CCompNodePtr cnode;
-
-    if( Nodes.count(string(node)) == 1 ){
-        cnode = Nodes[string(node)];
-    } else {
-        cnode = CCompNodePtr(new CCompNode);
-        cnode->Basic.SetNodeName(node);
-        Nodes[string(node)] = cnode;
-    }
-
-    cnode->InPowerOnMode = true;
-    cnode->PowerOnTime = ctime.GetSecondsFromBeginning();
-
-    NodesMutex.Unlock();
+    Nodes.SetPowerOnMode(string(node),true,ctime.GetSecondsFromBeginning());
 
 // call poweron script
     CSmallString cmd;
@@ -124,14 +108,14 @@ bool CFCGIStatServer::_RemoteAccessWakeOnLAN(CFCGIRequest& request,const CSmallS
     }
 
     cout << "> User: " << ruser << endl;
-    int ret = system(cmd);
 
-    if( ret != 0 ){
+    // the command is executed in background, the node mode is cleared on failure
+    if( Commands.Submit(ECK_POWERON,string(node),string(cmd)) == false ){
         CSmallString err;
-        err << "unable to execute power on command '" << cmd << "'";
-        ES_ERROR(cmd);
+        err << "unable to queue power on command '" << cmd << "'";
+        ES_ERROR(err);
         // unable to run - do not mark the node
-        cnode->InPowerOnMode = false;
+        Nodes.SetPowerOnMode(string(node),false,0);
     }
 
 // send the node list
@@ -158,7 +142,6 @@ bool CFCGIStatServer::_RemoteAccessStartVNC(CFCGIRequest& request,const CSmallSt
             CSmallString error;
             error << "illegal node name (" << node << ") from USER (" << ruser << ")";
             ES_ERROR(error);
-            request.FinishRequest();
             return(false);
         }
     }
@@ -172,22 +155,7 @@ bool CFCGIStatServer::_RemoteAccessStartVNC(CFCGIRequest& request,const CSmallSt
     ctime.GetActualTimeAndDate();
 
 // mark the node
-    NodesMutex.Lock();
-
-    CCompNodePtr cnode;
-
-    if( Nodes.count(string(node)) == 1 ){
-        cnode = Nodes[string(node)];
-    } else {
-        cnode = CCompNodePtr(new CCompNode);
-        cnode->Basic.SetNodeName(node);
-        Nodes[string(node)] = cnode;
-    }
-
-    cnode->InStartVNCMode = true;
-    cnode->StartVNCTime   = ctime.GetSecondsFromBeginning();
-
-    NodesMutex.Unlock();
+    Nodes.SetStartVNCMode(string(node),true,ctime.GetSecondsFromBeginning());
 
 // start RDSK
     CSmallString cmd;
@@ -204,14 +172,14 @@ bool CFCGIStatServer::_RemoteAccessStartVNC(CFCGIRequest& request,const CSmallSt
     }
 
     cout << "> Start RDSK: " << ruser << "@" << node << endl;
-    int ret = system(cmd);
 
-    if( ret != 0 ){
+    // the command is executed in background, the node mode is cleared on failure
+    if( Commands.Submit(ECK_STARTVNC,string(node),string(cmd)) == false ){
         CSmallString err;
-        err << "unable to execute start rdks command '" << cmd << "'";
-        ES_ERROR(cmd);
+        err << "unable to queue start rdsk command '" << cmd << "'";
+        ES_ERROR(err);
         // unable to run - do not mark the node
-        cnode->InStartVNCMode = false;
+        Nodes.SetStartVNCMode(string(node),false,0);
     }
 
 // send the node list
@@ -224,10 +192,15 @@ bool CFCGIStatServer::_RemoteAccessList(CFCGIRequest& request)
 {
     CSmallString ruser = request.Params.GetValue("REMOTE_USER");
 
-    NodesMutex.Lock();
+    CClusterSnapshotPtr snapshot = Nodes.GetSnapshot();
 
-    std::map<std::string,CCompNodePtr>::iterator it = Nodes.begin();
-    std::map<std::string,CCompNodePtr>::iterator ie = Nodes.end();
+    std::vector<CCompNodeConstPtr>::const_iterator it = snapshot->Nodes.begin();
+    std::vector<CCompNodeConstPtr>::const_iterator ie = snapshot->Nodes.end();
+
+    stringstream response;
+
+    CUserState  user_state;
+    bool        user_state_known = false;
 
     CSmallTimeAndDate ctime;
     ctime.GetActualTimeAndDate();
@@ -235,7 +208,7 @@ bool CFCGIStatServer::_RemoteAccessList(CFCGIRequest& request)
     int diff;
 
     while( it != ie ){
-        CCompNodePtr node = it->second;
+        CCompNodeConstPtr node = *it;
 
         CSmallString status = "up";
         CSmallString rdsk_url = "";
@@ -246,9 +219,9 @@ bool CFCGIStatServer::_RemoteAccessList(CFCGIRequest& request)
         EPowerStat nstat = node->PowerStat;
         if( (nstat == EPS_MAINTANANCE) || (nstat == EPS_UNKNOWN) ){
             status = "maintenance";
-            diff = ctime.GetSecondsFromBeginning() - node->Basic.GetTimeStamp();
+            diff = ctime.GetSecondsFromBeginning() - node->GetTimeStamp();
             if( diff > 240 ){  // skew 4m
-                node->Clear();
+                Nodes.ClearNode(node->Name,node->GetTimeStamp());
             }
         }
 
@@ -266,16 +239,16 @@ bool CFCGIStatServer::_RemoteAccessList(CFCGIRequest& request)
                 status = "maintenance"; // keep node in maintenance during poweroff procedure
             }
             if( status == "maintenance" ) {
-                diff = ctime.GetSecondsFromBeginning() - node->Basic.GetTimeStamp();
+                diff = ctime.GetSecondsFromBeginning() - node->GetTimeStamp();
                 if( diff > 240 ){   // skew 4m
                     status = "down";
-                    node->Clear();
+                    Nodes.ClearNode(node->Name,node->GetTimeStamp());
                 }
             }
         }
 
         if( status == "up" ){
-            diff = ctime.GetSecondsFromBeginning() - node->Basic.GetTimeStamp();
+            diff = ctime.GetSecondsFromBeginning() - node->GetTimeStamp();
             if( (nstat == EPS_UP) && (diff > 180) ){
                 // some weird node status
                 status = "maintenance";
@@ -288,7 +261,7 @@ bool CFCGIStatServer::_RemoteAccessList(CFCGIRequest& request)
                 if( diff < 60 ){
                     status = "startvnc";
                 } else {
-                    node->InStartVNCMode = false;
+                    Nodes.SetStartVNCMode(node->Name,false,node->StartVNCTime);
                 }
             }
 
@@ -335,7 +308,9 @@ bool CFCGIStatServer::_RemoteAccessList(CFCGIRequest& request)
 
                 rdsk_url << str.str();
 
-                node->InStartVNCMode = false;
+                if( node->InStartVNCMode ){
+                    Nodes.SetStartVNCMode(node->Name,false,node->StartVNCTime);
+                }
             }
 
             if( occupy && (status != "startvnc") && (status != "vnc") ){
@@ -344,52 +319,32 @@ bool CFCGIStatServer::_RemoteAccessList(CFCGIRequest& request)
         }
 
         if( status == "up" ){
-            CSmallString quota;
-            stringstream str;
-            try{
-                str << format(QuotaFlag)%ruser;
-                quota << str.str();
-            } catch (...) {
-                CSmallString err;
-                err << "unable to format quota flag '" << QuotaFlag << "'";
-                ES_ERROR(err);
-                quota = NULL;
-                quota << "blabla";
+            // the state depends only on the user - get it once per request
+            if( user_state_known == false ){
+                GetUserState(request,ruser,user_state);
+                user_state_known = true;
             }
-            if( CFileSystem::IsFile(quota) == true ){
+            if( user_state.QuotaExceeded ){
                 status = "quota";
-            }
-        }
-
-        if( status == "up" ){
-            if( HasKerberos(request) == false ){
+            } else if( user_state.HasKerberos == false ){
                 status = "up-nokrb";
             }
         }
 
         // write response
-        request.OutStream.PutStr(status); // node status
-        request.OutStream.PutChar(';');
-        request.OutStream.PutStr(node->Basic.GetNodeName()); // node name
-        request.OutStream.PutChar(';');
-        request.OutStream.PutStr(rdsk_url);
-        request.OutStream.PutChar(';');
-        request.OutStream.PutStr(vncid);
-        request.OutStream.PutChar(';');
-        request.OutStream.PutStr(node->NCPUs);
-        request.OutStream.PutChar(';');
-        request.OutStream.PutStr(node->NGPUs);
-        request.OutStream.PutChar('\n');
+        response << status << ';';                      // node status
+        response << node->Basic.GetNodeName() << ';';   // node name
+        response << rdsk_url << ';';
+        response << vncid << ';';
+        response << node->NCPUs << ';';
+        response << node->NGPUs << '\n';
 
         it++;
     }
 
-    NodesMutex.Unlock();
-
-    // finalize request
-    request.FinishRequest();
-
-    return(true);
+    // the list depends on the user
+    CResponseBody body(response.str(),ruser);
+    return(SendResponse(request,body));
 }
 
 //------------------------------------------------------------------------------
@@ -406,31 +361,60 @@ bool CFCGIStatServer::HasKerberos(CFCGIRequest& request)
 
 //------------------------------------------------------------------------------
 
+bool CFCGIStatServer::IsQuotaExceeded(const CSmallString& ruser)
+{
+    CSmallString quota;
+    stringstream str;
+    try{
+        str << format(QuotaFlag)%ruser;
+        quota << str.str();
+    } catch (...) {
+        CSmallString err;
+        err << "unable to format quota flag '" << QuotaFlag << "'";
+        ES_ERROR(err);
+        return(false);
+    }
+    return(CFileSystem::IsFile(quota));
+}
+
+//------------------------------------------------------------------------------
+
+void CFCGIStatServer::GetUserState(CFCGIRequest& request,const CSmallString& ruser,CUserState& state)
+{
+    string user = string(ruser);
+    string krb5ccname = string(request.Params.GetValue("KRB5CCNAME"));
+
+    if( UserStates.Get(user,krb5ccname,state) == true ) return;
+
+    CSmallTimeAndDate time;
+    time.GetActualTimeAndDate();
+
+    state.QuotaExceeded = IsQuotaExceeded(ruser);
+    state.HasKerberos   = HasKerberos(request);
+    state.KRB5CCName    = krb5ccname;
+    state.CreationTime  = time.GetSecondsFromBeginning();
+
+    UserStates.Set(user,state);
+}
+
+//------------------------------------------------------------------------------
+
 bool CFCGIStatServer::IsSocketLive(const CSmallString& socket)
 {
     // is it socket?
     if( CFileSystem::IsSocket(socket) == false ) return(false);
 
-    bool isactive = false;
-    CSmallString cmd;
-    cmd << "/usr/bin/cat /proc/net/unix";
-    FILE* p_sf = popen(cmd,"r");
-    if( p_sf ){
-        CSmallString buffer;
-        while( buffer.ReadLineFromFile(p_sf,true,true) ){
-            if( buffer.FindSubString(socket) != -1 ) isactive = true;
-        }
-        pclose(p_sf);
-    }
-
-    return(isactive);
+    // is anything bound to it?
+    return(SocketIndex.IsBound(socket));
 }
 
 //------------------------------------------------------------------------------
 
 bool CFCGIStatServer::CanStartRDSK(const CSmallString& node)
 {
-    EPowerStat status = Nodes[string(node)]->PowerStat;
+    EPowerStat status = EPS_UNKNOWN;
+    CCompNodeConstPtr cnode = Nodes.FindNode(string(node));
+    if( cnode ) status = cnode->PowerStat;
 
     if( status == EPS_UP ){
         // we can start RDSK on node, which is UP
@@ -447,7 +431,9 @@ bool CFCGIStatServer::CanStartRDSK(const CSmallString& node)
 
 bool CFCGIStatServer::CanPowerUp(const CSmallString& node)
 {
-    EPowerStat status = Nodes[string(node)]->PowerStat;
+    EPowerStat status = EPS_UNKNOWN;
+    CCompNodeConstPtr cnode = Nodes.FindNode(string(node));
+    if( cnode ) status = cnode->PowerStat;
 
     if( status == EPS_DOWN ){
         // we can turn on the node, which is down
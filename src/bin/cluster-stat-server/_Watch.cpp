@@ -0,0 +1,48 @@
+// =============================================================================
+//  Cluster Stat Server
+// -----------------------------------------------------------------------------
+//     Copyright (C) 2020 Petr Kulhanek (kulhanek@chemi.muni.cz)
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+
+#include "FCGIStatServer.hpp"
+#include <ErrorSystem.hpp>
+
+using namespace std;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CFCGIStatServer::_Watch(CFCGIRequestPtr& p_request)
+{
+    // the stream is served by the notifier thread
+    if( Notifier.Subscribe(p_request) == true ) return(true);
+
+    p_request->OutStream.PutStr("Status: 503 Service Unavailable\r\n");
+    p_request->OutStream.PutStr("Content-type: text/html\r\n");
+    p_request->OutStream.PutStr("Retry-After: 30\r\n");
+    p_request->OutStream.PutStr("\r\n");
+    p_request->OutStream.PutStr("too many subscribers");
+    p_request->FinishRequest();
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
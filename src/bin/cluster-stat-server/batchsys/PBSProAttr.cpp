@@ -34,14 +34,11 @@ using namespace boost;
 //------------------------------------------------------------------------------
 //==============================================================================
 
-bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
-                   bool& value,bool emit_error)
+// conversions - p_a is the found attribute or NULL
+
+static bool convert_attribute(struct attrl* p_a,const char* p_name,const char* p_res,
+                              bool& value,bool emit_error)
 {
-    if( p_first == NULL ){
-        ES_ERROR("p_first is NULL");
-        return(false);
-    }
-    struct attrl* p_a = FindAttr(p_first,p_name,p_res,emit_error);
     if( p_a == NULL ) return(!emit_error);
 
     // convert
@@ -66,14 +63,9 @@ bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
 
 //------------------------------------------------------------------------------
 
-bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
-                   int& value,bool emit_error)
+static bool convert_attribute(struct attrl* p_a,const char* p_name,const char* p_res,
+                              int& value,bool emit_error)
 {
-    if( p_first == NULL ){
-        ES_ERROR("p_first is NULL");
-        return(false);
-    }
-    struct attrl* p_a = FindAttr(p_first,p_name,p_res,emit_error);
     if( p_a == NULL ) return(!emit_error);
 
     // convert
@@ -93,14 +85,9 @@ bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
 
 //------------------------------------------------------------------------------
 
-bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
-                   size_t& value,bool emit_error)
+static bool convert_attribute(struct attrl* p_a,const char* p_name,const char* p_res,
+                              size_t& value,bool emit_error)
 {
-    if( p_first == NULL ){
-        ES_ERROR("p_first is NULL");
-        return(false);
-    }
-    struct attrl* p_a = FindAttr(p_first,p_name,p_res,emit_error);
     if( p_a == NULL ) return(!emit_error);
 
     // convert
@@ -120,14 +107,9 @@ bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
 
 //------------------------------------------------------------------------------
 
-bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
-                   CSmallString& value,bool emit_error)
+static bool convert_attribute(struct attrl* p_a,const char* p_name,const char* p_res,
+                              CSmallString& value,bool emit_error)
 {
-    if( p_first == NULL ){
-        ES_ERROR("p_first is NULL");
-        return(false);
-    }
-    struct attrl* p_a = FindAttr(p_first,p_name,p_res,emit_error);
     if( p_a == NULL ) return(!emit_error);
 
     // convert
@@ -138,11 +120,11 @@ bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
 
 //------------------------------------------------------------------------------
 
-bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
-                   CSmallTime& value,bool emit_error)
+static bool convert_attribute(struct attrl* p_a,const char* p_name,const char* p_res,
+                              CSmallTime& value,bool emit_error)
 {
     CSmallString stime;
-    if( get_attribute(p_first,p_name,p_res,stime,emit_error) == false ){
+    if( convert_attribute(p_a,p_name,p_res,stime,emit_error) == false ){
         return(false);
     }
     int len = stime.GetLength();
@@ -183,11 +165,11 @@ bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
 
 //------------------------------------------------------------------------------
 
-bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
-                   std::vector<std::string>& values,const char* p_delim,bool emit_error)
+static bool convert_attribute(struct attrl* p_a,const char* p_name,const char* p_res,
+                              std::vector<std::string>& values,const char* p_delim,bool emit_error)
 {
     CSmallString list;
-    if( get_attribute(p_first,p_name,p_res,list,emit_error) == false ){
+    if( convert_attribute(p_a,p_name,p_res,list,emit_error) == false ){
         return(false);
     }
 
@@ -200,11 +182,11 @@ bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
 
 //------------------------------------------------------------------------------
 
-bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
-                   std::vector<CSmallString>& values,const char* p_delim,bool emit_error)
+static bool convert_attribute(struct attrl* p_a,const char* p_name,const char* p_res,
+                              std::vector<CSmallString>& values,const char* p_delim,bool emit_error)
 {
     std::vector<std::string> svalues;
-    bool rst = get_attribute(p_first,p_name,p_res,svalues,p_delim,emit_error);
+    bool rst = convert_attribute(p_a,p_name,p_res,svalues,p_delim,emit_error);
 
     std::vector<std::string>::iterator it = svalues.begin();
     std::vector<std::string>::iterator ie = svalues.end();
@@ -221,6 +203,217 @@ bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
 //------------------------------------------------------------------------------
 //==============================================================================
 
+bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
+                   bool& value,bool emit_error)
+{
+    if( p_first == NULL ){
+        ES_ERROR("p_first is NULL");
+        return(false);
+    }
+    struct attrl* p_a = FindAttr(p_first,p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,value,emit_error));
+}
+
+//------------------------------------------------------------------------------
+
+bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
+                   int& value,bool emit_error)
+{
+    if( p_first == NULL ){
+        ES_ERROR("p_first is NULL");
+        return(false);
+    }
+    struct attrl* p_a = FindAttr(p_first,p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,value,emit_error));
+}
+
+//------------------------------------------------------------------------------
+
+bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
+                   size_t& value,bool emit_error)
+{
+    if( p_first == NULL ){
+        ES_ERROR("p_first is NULL");
+        return(false);
+    }
+    struct attrl* p_a = FindAttr(p_first,p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,value,emit_error));
+}
+
+//------------------------------------------------------------------------------
+
+bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
+                   CSmallString& value,bool emit_error)
+{
+    if( p_first == NULL ){
+        ES_ERROR("p_first is NULL");
+        return(false);
+    }
+    struct attrl* p_a = FindAttr(p_first,p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,value,emit_error));
+}
+
+//------------------------------------------------------------------------------
+
+bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
+                   CSmallTime& value,bool emit_error)
+{
+    if( p_first == NULL ){
+        ES_ERROR("p_first is NULL");
+        return(false);
+    }
+    struct attrl* p_a = FindAttr(p_first,p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,value,emit_error));
+}
+
+//------------------------------------------------------------------------------
+
+bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
+                   std::vector<std::string>& values,const char* p_delim,bool emit_error)
+{
+    if( p_first == NULL ){
+        ES_ERROR("p_first is NULL");
+        return(false);
+    }
+    struct attrl* p_a = FindAttr(p_first,p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,values,p_delim,emit_error));
+}
+
+//------------------------------------------------------------------------------
+
+bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
+                   std::vector<CSmallString>& values,const char* p_delim,bool emit_error)
+{
+    if( p_first == NULL ){
+        ES_ERROR("p_first is NULL");
+        return(false);
+    }
+    struct attrl* p_a = FindAttr(p_first,p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,values,p_delim,emit_error));
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   bool& value,bool emit_error)
+{
+    struct attrl* p_a = index.Find(p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,value,emit_error));
+}
+
+//------------------------------------------------------------------------------
+
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   int& value,bool emit_error)
+{
+    struct attrl* p_a = index.Find(p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,value,emit_error));
+}
+
+//------------------------------------------------------------------------------
+
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   size_t& value,bool emit_error)
+{
+    struct attrl* p_a = index.Find(p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,value,emit_error));
+}
+
+//------------------------------------------------------------------------------
+
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   CSmallString& value,bool emit_error)
+{
+    struct attrl* p_a = index.Find(p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,value,emit_error));
+}
+
+//------------------------------------------------------------------------------
+
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   CSmallTime& value,bool emit_error)
+{
+    struct attrl* p_a = index.Find(p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,value,emit_error));
+}
+
+//------------------------------------------------------------------------------
+
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   std::vector<std::string>& values,const char* p_delim,bool emit_error)
+{
+    struct attrl* p_a = index.Find(p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,values,p_delim,emit_error));
+}
+
+//------------------------------------------------------------------------------
+
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   std::vector<CSmallString>& values,const char* p_delim,bool emit_error)
+{
+    struct attrl* p_a = index.Find(p_name,p_res,emit_error);
+    return(convert_attribute(p_a,p_name,p_res,values,p_delim,emit_error));
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CPBSProAttrIndex::CPBSProAttrIndex(struct attrl* p_first)
+{
+    // the first occurrence wins as in FindAttr()
+    while( p_first != NULL ){
+        if( p_first->name != NULL ){
+            string name(p_first->name);
+            Attributes.insert(std::make_pair(name,p_first));
+            if( p_first->resource != NULL ){
+                Attributes.insert(std::make_pair(GetKey(p_first->name,p_first->resource),p_first));
+            }
+        }
+        p_first = p_first->next;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+struct attrl* CPBSProAttrIndex::Find(const char* p_name,const char* p_res,bool emit_error) const
+{
+    std::string key;
+    if( p_res == NULL ){
+        key = p_name;
+    } else {
+        key = GetKey(p_name,p_res);
+    }
+
+    boost::unordered_map<std::string,struct attrl*>::const_iterator it = Attributes.find(key);
+    if( it != Attributes.end() ) return(it->second);
+
+    if( emit_error ){
+        CSmallString error;
+        error << "unable to find attribute '" << p_name << "' (" << p_res << ")";
+        ES_ERROR(error);
+    }
+
+    return(NULL);
+}
+
+//------------------------------------------------------------------------------
+
+std::string CPBSProAttrIndex::GetKey(const char* p_name,const char* p_res)
+{
+    // names cannot contain '\n'
+    std::string key(p_name);
+    key += '\n';
+    key += p_res;
+    return(key);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
 struct attrl* FindAttr(struct attrl* p_list,const char* p_name,const char* p_res,
                        bool emit_error)
 {
@@ -403,6 +596,20 @@ void set_attribute(struct attrl* &p_prev,const char* p_name,const char* p_res,co
     p_prev = p_attr;
 }
 
+//------------------------------------------------------------------------------
+
+void free_attributes(struct attrl* p_first)
+{
+    while( p_first != NULL ){
+        struct attrl* p_next = p_first->next;
+        free(p_first->name);
+        free(p_first->resource);
+        free(p_first->value);
+        free(p_first);
+        p_first = p_next;
+    }
+}
+
 //==============================================================================
 //------------------------------------------------------------------------------
 //==============================================================================
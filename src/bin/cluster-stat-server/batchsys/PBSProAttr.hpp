@@ -26,6 +26,28 @@
 #include <vector>
 #include <string>
 #include <pbs_ifl.h>
+#include <boost/unordered_map.hpp>
+
+// -----------------------------------------------------------------------------
+
+//! hashed view of attribute list
+/*!
+  the list is indexed in one pass by (name) and by (name, resource),
+  the list must exist as long as the index is used
+*/
+
+class CPBSProAttrIndex {
+public:
+    CPBSProAttrIndex(struct attrl* p_first);
+
+    //! find attribute, p_res can be NULL
+    struct attrl* Find(const char* p_name,const char* p_res,bool emit_error) const;
+
+private:
+    boost::unordered_map<std::string,struct attrl*>   Attributes;
+
+    static std::string GetKey(const char* p_name,const char* p_res);
+};
 
 // -----------------------------------------------------------------------------
 
@@ -44,12 +66,30 @@ bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
 bool get_attribute(struct attrl* p_first,const char* p_name,const char* p_res,
                    std::vector<CSmallString>& values,const char* p_delim=",",bool emit_error=false);
 
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   bool& value,bool emit_error=false);
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   int& value,bool emit_error=false);
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   size_t& value,bool emit_error=false);
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   CSmallString& value,bool emit_error=false);
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   CSmallTime& value,bool emit_error=false);
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   std::vector<std::string>& values,const char* p_delim=",",bool emit_error=false);
+bool get_attribute(const CPBSProAttrIndex& index,const char* p_name,const char* p_res,
+                   std::vector<CSmallString>& values,const char* p_delim=",",bool emit_error=false);
+
 void set_attribute(struct attropl* &p_prev,const char* p_name,const char* p_res,const char* p_value);
 void set_attribute(struct attropl* &p_prev,const char* p_name,const char* p_res,
                    const char* p_value,enum batch_op op);
 
 void set_attribute(struct attrl* &p_prev,const char* p_name,const char* p_res,const char* p_value);
 
+//! release list created by set_attribute
+void free_attributes(struct attrl* p_first);
+
 // -----------------------------------------------------------------------------
 
 struct attrl* FindAttr(struct attrl* p_list,const char* p_name,const char* p_res,
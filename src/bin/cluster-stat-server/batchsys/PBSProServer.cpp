@@ -23,6 +23,7 @@
 #include <ErrorSystem.hpp>
 #include <iostream>
 #include <pbs_ifl.h>
+#include <pbs_error.h>
 #include <stdlib.h>
 #include <string.h>
 #include <PBSProAttr.hpp>
@@ -48,6 +49,7 @@ CPBSProServer PBSPro;
 CPBSProServer::CPBSProServer(void)
 {
     ServerID = 0;
+    NodeAttribs = NULL;
 
     pbspro_connect = NULL;
     pbspro_disconnect = NULL;
@@ -69,6 +71,7 @@ CPBSProServer::CPBSProServer(void)
 CPBSProServer::~CPBSProServer(void)
 {
     DisconnectFromServer();
+    free_attributes(NodeAttribs);
 }
 
 //==============================================================================
@@ -105,6 +108,13 @@ bool CPBSProServer::Init(const CSmallString& libs_tok,const CSmallString& server
 
     ServerName = server_name;
 
+    // only resources used by UpdateNodePowerStatus() are requested
+    struct attrl* p_last = NULL;
+    set_attribute(p_last,"resources_available","ncpus",NULL);
+    NodeAttribs = p_last;
+    set_attribute(p_last,"resources_available","ngpus",NULL);
+    set_attribute(p_last,"resources_available","power_status",NULL);
+
     return(true);
 }
 
@@ -216,6 +226,21 @@ bool CPBSProServer::DisconnectFromServer(void)
 
 //------------------------------------------------------------------------------
 
+bool CPBSProServer::IsConnected(void)
+{
+    return(ServerID > 0);
+}
+
+//------------------------------------------------------------------------------
+
+int CPBSProServer::GetLastError(void)
+{
+    if( pbspro_errno == NULL ) return(PBSE_NONE);
+    return(*pbspro_errno());
+}
+
+//------------------------------------------------------------------------------
+
 void CPBSProServer::PrintBatchStatus(std::ostream& sout,struct batch_status* p_bs)
 {
     int i = 0;
@@ -262,8 +287,16 @@ void CPBSProServer::PrintAttributes(std::ostream& sout,struct attropl* p_as)
 
 bool CPBSProServer::UpdateNodes(void)
 {
-    struct batch_status* p_node_attrs = pbspro_stathost(ServerID,NULL,NULL,NULL);
+    *pbspro_errno() = PBSE_NONE;
+
+    struct batch_status* p_node_attrs = pbspro_stathost(ServerID,NULL,NodeAttribs,NULL);
     if( p_node_attrs == NULL ){
+        // no nodes or an error
+        int error = GetLastError();
+        if( error == PBSE_NONE ) return(true);
+        CSmallString msg;
+        msg << "unable to get nodes from server '" << ServerName << "' (pbs_errno = " << error << ")";
+        ES_TRACE_ERROR(msg);
         return(false);
     }
 
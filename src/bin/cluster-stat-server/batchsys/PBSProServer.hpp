@@ -46,7 +46,7 @@ typedef void (*PBS_STATFREE)(struct batch_status *);
 typedef char* (*PBS_GETERRMSG)(int connect);
 typedef char* (*PBS_LOCJOB)(int,char*,char*);
 typedef char* (*PBS_STRERROR)(int);
-typedef int (*PBS_ERRNO)(void);
+typedef int* (*PBS_ERRNO)(void);
 
 // -----------------------------------------------------------------------------
 
@@ -66,11 +66,17 @@ public:
     //! disconnect from server
     bool DisconnectFromServer(void);
 
+    //! is the connection opened?
+    bool IsConnected(void);
+
 // execution -------------------------------------------------------------------
     //! get last error message
     const CSmallString GetLastErrorMsg(void);
 
-    //! update node statuses
+    //! get pbs_errno of the last call
+    int GetLastError(void);
+
+    //! update node statuses, false on error - the connection is then likely broken
     bool UpdateNodes(void);
 
 // section of private data -----------------------------------------------------
@@ -79,6 +85,7 @@ private:
     CSmallString    PBSProLibName;
     CDynamicPackage PBSProLib;
     int             ServerID;
+    struct attrl*   NodeAttribs;    // attributes requested by UpdateNodes()
 
     // init symbols
     bool InitSymbols(void);